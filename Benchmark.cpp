@@ -0,0 +1,271 @@
+#include "Benchmark.h"
+#include "Cdlod.h"
+#include "DiamondSquare.h"
+#include "Frustum.h"
+#include "Heightfield.h"
+#include "HeightGenerator.h"
+#include "Noise.h"
+#include "NoiseGraph.h"
+#include "Simd.h"
+#include "Spectral.h"
+#include "ThreadPool.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+// Лучшее время из reps прогонов, в секундах
+static double bestOf(int reps, const std::function<void()>& fn) {
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return best;
+}
+
+static const char* fractalName(FractalType t) {
+    switch (t) {
+    case FractalType::Fbm:    return "fBm";
+    case FractalType::Ridged: return "Ridged";
+    case FractalType::Billow: return "Billow";
+    case FractalType::Hybrid: return "Hybrid";
+    default:                  return "?";
+    }
+}
+
+static const char* basisName(NoiseBasis b) {
+    switch (b) {
+    case NoiseBasis::Perlin:    return "Perlin (seeded)";
+    case NoiseBasis::GlmPerlin: return "glm::perlin";
+    case NoiseBasis::Simplex:   return "Simplex";
+    default:                    return "?";
+    }
+}
+
+// Сэмплы шума в секунду: одна октава, батч из случайных точек
+static void benchNoise() {
+    const int count = 1 << 18;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-500.0f, 500.0f);
+    std::vector<float> x(count), z(count), out(count);
+    for (int i = 0; i < count; ++i) { x[i] = dist(rng); z[i] = dist(rng); }
+
+    // исходный путь Terrain::generate: скалярный glm::perlin на точку
+    FbmParams ref{ 0.04f, 0.0f, 1 };
+    double refSec = bestOf(3, [&] {
+        for (int i = 0; i < count; ++i) out[i] = fbmReference(ref, x[i], z[i]);
+        });
+    double refRate = count / refSec;
+    std::printf("Noise, 1 octave, %d samples, 1 thread\n", count);
+    std::printf("  %-18s %-8s %10.1f M/s  x%.2f\n", "glm::perlin loop", "-", refRate * 1e-6, 1.0);
+
+    for (int b = 0; b < int(NoiseBasis::Count); ++b) {
+        FbmParams p{ 0.04f, 0.0f, 1 };
+        p.basis = NoiseBasis(b);
+        p = fbmWithTables(p);
+        for (int l = 0; l <= int(cpuSimdLevel()); ++l) {
+            const SimdKernels& k = simdKernels(SimdLevel(l));
+            double sec = bestOf(5, [&] {
+                k.fbm[b](p, x.data(), z.data(), count, out.data(), nullptr, nullptr);
+                });
+            std::printf("  %-18s %-8s %10.1f M/s  x%.2f\n", basisName(NoiseBasis(b)),
+                simdLevelName(SimdLevel(l)), count / sec * 1e-6, count / sec / refRate);
+        }
+    }
+}
+
+// Наивный F1: для каждой точки заново хеш и перебор 9 клеток
+static float worleyNaive(const WorleyParams& p, float x, float z) {
+    float px = x * p.frequency, pz = z * p.frequency;
+    float cx = std::floor(px), cz = std::floor(pz), best = 1e30f;
+    for (int dz = -1; dz <= 1; ++dz)
+        for (int dx = -1; dx <= 1; ++dx) {
+            int qx = int(cx) + dx, qz = int(cz) + dz;
+            uint32_t h = uint32_t(qx) * 0x8DA6B343u ^ uint32_t(qz) * 0xD8163841u ^ p.seed * 0xCB1AB31Fu;
+            h ^= h >> 16; h *= 0x7FEB352Du;
+            h ^= h >> 15; h *= 0x846CA68Bu;
+            h ^= h >> 16;
+            float fx = qx + 0.5f - 0.5f * p.jitter + p.jitter * float(h & 0xFFFFu) * (1.0f / 65536.0f);
+            float fz = qz + 0.5f - 0.5f * p.jitter + p.jitter * float(h >> 16) * (1.0f / 65536.0f);
+            best = std::min(best, (px - fx) * (px - fx) + (pz - fz) * (pz - fz));
+        }
+    return std::sqrt(best);
+}
+
+// Worley по рядам сетки: батч против наивного перебора на точку
+static void benchWorley(int N) {
+    WorleyParams p{ 0.06f };
+    std::vector<float> xs(N), zs(N), out(N);
+    for (int i = 0; i < N; ++i) xs[i] = -32.0f + 64.0f * i / (N - 1);
+    auto rows = [&](const std::function<void(int)>& fn) {
+        return bestOf(3, [&] {
+            for (int r = 0; r < N; ++r) {
+                std::fill(zs.begin(), zs.end(), -32.0f + 64.0f * r / (N - 1));
+                fn(r);
+            }
+            });
+    };
+    double naive = rows([&](int) { for (int i = 0; i < N; ++i) out[i] = worleyNaive(p, xs[i], zs[i]); });
+    std::printf("Worley F1, %dx%d rows, 1 thread\n", N, N);
+    std::printf("  %-18s %-8s %8.1f ms\n", "naive 3x3 scan", "-", naive * 1e3);
+    for (int l = 0; l <= int(cpuSimdLevel()); ++l) {
+        const SimdKernels& k = simdKernels(SimdLevel(l));
+        double sec = rows([&](int) { k.worley(p, xs.data(), zs.data(), N, out.data()); });
+        std::printf("  %-18s %-8s %8.1f ms  x%.2f\n", "batched", simdLevelName(SimdLevel(l)),
+            sec * 1e3, naive / sec);
+    }
+}
+
+// Полная сетка высот (8 октав, с градиентами) на активном уровне SIMD и пуле
+static void benchGrid(int N) {
+    ThreadPool& pool = ThreadPool::shared();
+    Heightfield hf(N, N, 64.0f / (N - 1), -32.0f, -32.0f);
+    std::printf("Heightfield %dx%d, 8 octaves, %s, %d threads\n", N, N,
+        simdLevelName(activeSimdLevel()), pool.threadCount());
+    for (int b = 0; b < int(NoiseBasis::Count); ++b) {
+        FbmParams p{ 0.04f, 0.0f, 8 };
+        p.basis = NoiseBasis(b);
+        double sec = bestOf(3, [&] { generateFbmHeights(hf, p, 50.0f, pool); });
+        std::printf("  %-18s %8.1f ms  %8.1f M octave-samples/s\n", basisName(NoiseBasis(b)),
+            sec * 1e3, double(N) * N * 8 / sec * 1e-6);
+    }
+    {
+        FbmParams p{ 0.04f, 0.0f, 8 };
+        p.warpStrength = 8.0f;
+        double sec = bestOf(3, [&] { generateFbmHeights(hf, p, 50.0f, pool); });
+        std::printf("  %-18s %8.1f ms  %8.1f M octave-samples/s\n", "fBm + warp",
+            sec * 1e3, double(N) * N * 8 / sec * 1e-6);
+    }
+    {
+        // тот же fBm и форма, но через граф: цена интерпретатора против ручного цикла
+        FbmParams p{ 0.04f, 0.0f, 8 };
+        double direct = bestOf(3, [&] { generateFbmHeights(hf, p, 50.0f, pool, false); });
+        NoiseGraph g;
+        NoiseGraph::Node s = g.affine(g.fractal(p), 0.5f, 0.5f);
+        g.affine(g.mul(s, s), 50.0f, 0.0f);
+        NoiseProgram prog = g.compile();
+        double sec = bestOf(3, [&] { generateGraphHeights(hf, prog, pool); });
+        std::printf("  %-18s %8.1f ms  (direct %.1f ms, x%.2f)\n", "fBm via graph",
+            sec * 1e3, direct * 1e3, sec / direct);
+    }
+    for (int t = 1; t < int(FractalType::Count); ++t) {
+        FbmParams p{ 0.04f, 0.0f, 8 };
+        p.fractal = FractalType(t);
+        double sec = bestOf(3, [&] { generateFbmHeights(hf, p, 50.0f, pool); });
+        std::printf("  %-18s %8.1f ms  %8.1f M octave-samples/s\n", fractalName(FractalType(t)),
+            sec * 1e3, double(N) * N * 8 / sec * 1e-6);
+    }
+    {
+        // всё поле одним БПФ: цена не зависит от числа октав; период N-1 и
+        // ближайшая степень двойки (самый быстрый размер)
+        SpectralParams sp;
+        int pow2 = 1;
+        while (pow2 * 2 <= N - 1) pow2 *= 2;
+        std::vector<int> periods{ N - 1 };
+        if (pow2 != N - 1) periods.push_back(pow2);
+        for (int period : periods) {
+            Heightfield sf(period + 1, period + 1, hf.spacing(), -32.0f, -32.0f);
+            double sec = bestOf(3, [&] { generateSpectralHeights(sf, sp, 50.0f, pool); });
+            std::printf("  %-18s %8.1f ms  period %d\n", "spectral (FFT)", sec * 1e3, period);
+        }
+    }
+}
+
+// Отсечение AABB пирамидой: случайные боксы вокруг камеры, по уровням SIMD
+static void benchCull() {
+    const int count = 1 << 20;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-400.0f, 400.0f), size(0.5f, 20.0f);
+    std::vector<float> b[6];
+    for (std::vector<float>& v : b) v.resize(count);
+    for (int i = 0; i < count; ++i) {
+        float x = pos(rng), y = pos(rng) * 0.2f, z = pos(rng), s = size(rng);
+        b[0][i] = x; b[1][i] = y; b[2][i] = z;
+        b[3][i] = x + s; b[4][i] = y + s; b[5][i] = z + s;
+    }
+    const float* boxes[6] = { b[0].data(), b[1].data(), b[2].data(), b[3].data(), b[4].data(), b[5].data() };
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 50.0f, 100.0f), glm::vec3(0.0f, 30.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+    Frustum f = Frustum::fromMatrix(proj * view);
+    std::vector<uint8_t> visible(count);
+
+    std::printf("Frustum culling, %d AABBs, 1 thread\n", count);
+    double scalar = 0.0;
+    for (int l = 0; l <= int(cpuSimdLevel()); ++l) {
+        const SimdKernels& k = simdKernels(SimdLevel(l));
+        double sec = bestOf(5, [&] { k.frustumCull(&f.planes[0].x, boxes, count, visible.data()); });
+        if (l == 0) scalar = sec;
+        int n = 0;
+        for (uint8_t v : visible) n += v;
+        std::printf("  %-18s %-8s %8.2f ms  %d visible  x%.2f\n", "AABB vs frustum",
+            simdLevelName(SimdLevel(l)), sec * 1e3, n, scalar / sec);
+    }
+}
+
+// Diamond-square против fBm (Perlin, 8 октав) на сетках 1k-8k; 8k fBm —
+// несколько секунд на поток, поэтому большие сетки — по одному прогону
+static void benchDiamondSquare() {
+    ThreadPool& pool = ThreadPool::shared();
+    std::printf("Diamond-square vs fBm (Perlin, 8 octaves), %d threads\n", pool.threadCount());
+    for (int N : { 1025, 2049, 4097, 8193 }) {
+        Heightfield hf(N, N, 64.0f / (N - 1), -32.0f, -32.0f);
+        int reps = N <= 2049 ? 3 : 1;
+        FbmParams p{ 0.04f, 0.0f, 8 };
+        double fbm = bestOf(reps, [&] { generateFbmHeights(hf, p, 50.0f, pool, false); });
+        DiamondSquareParams dp;
+        double blocked = bestOf(reps, [&] { generateDiamondSquareHeights(hf, dp, 50.0f, pool); });
+        dp.blockSize = 0;
+        double plain = bestOf(reps, [&] { generateDiamondSquareHeights(hf, dp, 50.0f, pool); });
+        std::printf("  %5d: fBm %8.1f ms  full-grid passes %7.1f ms  blocked %7.1f ms  (x%.1f vs fBm)\n",
+            N - 1, fbm * 1e3, plain * 1e3, blocked * 1e3, fbm / blocked);
+    }
+}
+
+// CDLOD: мир растёт при том же шаге сетки, рельеф — fBm по умолчанию,
+// камера в центре над ним, 1080p, fovY 45. Треугольников ~ число уровней,
+// а не площадь (пока мир больше диапазона уровня 0).
+static void benchCdlod() {
+    ThreadPool& pool = ThreadPool::shared();
+    const float projScale = 1080.0f / (2.0f * std::tan(glm::radians(22.5f)));
+    std::printf("CDLOD selection (patch %d, 1080p), spacing 0.5\n", CDLOD_PATCH);
+    for (int N : { 257, 1025, 4097, 8193 }) {
+        float half = 0.25f * (N - 1);
+        Heightfield hf(N, N, 0.5f, -half, -half);
+        generateFbmHeights(hf, FbmParams{ 0.04f, 0.0f, 4 }, 50.0f, pool, false);
+        CdlodTree tree;
+        tree.build(hf, pool);
+
+        glm::vec3 eye(0.0f, hf.maxHeight() + 2.0f, 0.0f);
+        glm::mat4 vp = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 4.0f * half) *
+                       glm::lookAt(eye, eye + glm::vec3(1.0f, -0.2f, 0.3f), glm::vec3(0.0f, 1.0f, 0.0f));
+        Frustum f = Frustum::fromMatrix(vp);
+        std::vector<CdlodQuad> quads;
+        for (float pixelError : { 1.0f, 4.0f }) {
+            tree.setRanges(pixelError, projScale);
+            double t = bestOf(20, [&] { tree.select(eye, f, quads); });
+            size_t tris = quads.size() * (CDLOD_PATCH / 2) * (CDLOD_PATCH / 2) * 2;
+            std::printf("  %5d, %.0f px: %d levels, %5zu quads, %6.3f M triangles (full grid %6.1f M), select %.3f ms\n",
+                N - 1, pixelError, tree.levels(), quads.size(), tris * 1e-6,
+                2.0 * (N - 1) * (N - 1) * 1e-6, t * 1e3);
+        }
+    }
+}
+
+int runBenchmarks(int argc, char** argv) {
+    int N = argc > 1 ? std::atoi(argv[1]) : 1024;
+    if (N < 2) N = 1024;
+    benchNoise();
+    benchWorley(N);
+    benchGrid(N);
+    benchCull();
+    benchDiamondSquare();
+    benchCdlod();
+    return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Замеры генерации без окна и GL: Terrain_try --bench [gridSize]
+// Печатает таблицу в stdout, возвращает код выхода для main.
+int runBenchmarks(int argc, char** argv);
@@ -1,6 +1,6 @@
 #include "Camera.h"
 
-// 
+// Конструктор
 Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
     : Front(glm::vec3(0.0f, -0.5f, -1.0f)),
     MovementSpeed(50.0f),
@@ -16,10 +16,10 @@ public:
     glm::vec3 Up;
     glm::vec3 Right;
     glm::vec3 WorldUp;
-    //  
+    // углы Эйлера
     float Yaw;
     float Pitch;
-    // 
+    // настройки
     float MovementSpeed;
     float MouseSensitivity;
     float Zoom;
@@ -0,0 +1,297 @@
+#include "Cdlod.h"
+#include "Frustum.h"
+#include "Heightfield.h"
+#include "Shader.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+// Пустой узел (целиком за краем сетки): min > max
+const glm::vec2 EMPTY_NODE(FLT_MAX, -FLT_MAX);
+
+// Доля диапазона уровня (от границы предыдущего), после которой начинается geomorph
+const float MORPH_START = 0.66f;
+
+float distanceSq(const glm::vec3& p, const glm::vec3& lo, const glm::vec3& hi) {
+    glm::vec3 d = glm::max(glm::max(lo - p, p - hi), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+} // namespace
+
+void CdlodTree::build(const Heightfield& hf, ThreadPool& pool) {
+    int W = hf.width(), D = hf.depth();
+    gridW = W;
+    gridD = D;
+    spacing = hf.spacing();
+    orgX = hf.originX();
+    orgZ = hf.originZ();
+    rootSize = CDLOD_PATCH;
+    levelCount = 1;
+    while (rootSize < std::max(W, D) - 1) { rootSize *= 2; ++levelCount; }
+
+    // 1) ярус 0: узлы по CDLOD_PATCH / 2 ячеек, включая узлы общего края
+    const int Q = CDLOD_PATCH / 2;
+    minMax.assign(levelCount + 1, {});
+    int side = tierSide(0);
+    minMax[0].assign(size_t(side) * side, EMPTY_NODE);
+    pool.parallelFor(0, side, 1, [&](int b, int e) {
+        for (int nz = b; nz < e; ++nz) {
+            int z0 = nz * Q, z1 = std::min(z0 + Q, D - 1);
+            if (z0 >= D - 1) continue;
+            for (int z = z0; z <= z1; ++z) {
+                const float* r = hf.row(z);
+                for (int nx = 0; nx < side && nx * Q < W - 1; ++nx) {
+                    int x0 = nx * Q, x1 = std::min(x0 + Q, W - 1);
+                    auto mm = std::minmax_element(r + x0, r + x1 + 1);
+                    glm::vec2& n = minMax[0][size_t(nz) * side + nx];
+                    n.x = std::min(n.x, *mm.first);
+                    n.y = std::max(n.y, *mm.second);
+                }
+            }
+        }
+        });
+    // 2) ярусы выше — по четырём детям
+    for (int t = 1; t <= levelCount; ++t) {
+        int s = tierSide(t), cs = tierSide(t - 1);
+        minMax[t].assign(size_t(s) * s, EMPTY_NODE);
+        for (int nz = 0; nz < s; ++nz)
+            for (int nx = 0; nx < s; ++nx) {
+                glm::vec2& n = minMax[t][size_t(nz) * s + nx];
+                for (int c = 0; c < 4; ++c) {
+                    const glm::vec2& m = minMax[t - 1][size_t(2 * nz + (c >> 1)) * cs + 2 * nx + (c & 1)];
+                    n.x = std::min(n.x, m.x);
+                    n.y = std::max(n.y, m.y);
+                }
+            }
+    }
+
+    // 3) ошибка уровня L: наибольшее отклонение узла от билинейной
+    //    интерполяции по сетке с шагом 2^L (то, что патч уровня L теряет)
+    std::vector<float> rowErr(size_t(D) * levelCount, 0.0f);
+    pool.parallelFor(0, D, rowBand(W), [&](int b, int e) {
+        for (int z = b; z < e; ++z) {
+            const float* r = hf.row(z);
+            for (int L = 1; L < levelCount; ++L) {
+                int s = 1 << L;
+                int za = z / s * s, zb = std::min(za + s, D - 1);
+                float fz = zb > za ? float(z - za) / float(zb - za) : 0.0f;
+                const float* ra = hf.row(za);
+                const float* rb = hf.row(zb);
+                float err = 0.0f;
+                for (int x = 0; x < W; ++x) {
+                    int xa = x / s * s, xb = std::min(xa + s, W - 1);
+                    float fx = xb > xa ? float(x - xa) / float(xb - xa) : 0.0f;
+                    float a = ra[xa] + (ra[xb] - ra[xa]) * fx;
+                    float c = rb[xa] + (rb[xb] - rb[xa]) * fx;
+                    err = std::max(err, std::fabs(r[x] - (a + (c - a) * fz)));
+                }
+                rowErr[size_t(L) * D + z] = err;
+            }
+        }
+        });
+    errors.assign(levelCount, 0.0f);
+    for (int L = 1; L < levelCount; ++L)
+        errors[L] = *std::max_element(rowErr.begin() + size_t(L) * D, rowErr.begin() + size_t(L + 1) * D);
+    setRanges(1.0f, 1300.0f);
+}
+
+void CdlodTree::setRanges(float pixelError, float projScale) {
+    ranges.assign(levelCount, FLT_MAX);
+    if (levelCount < 2) return;
+    // полный шаг нужен, пока огрубление до уровня 1 заметно: errors[1] в
+    // пикселях на этом расстоянии больше pixelError. Не меньше 3 сторон листа:
+    // узел граничит только с соседними уровнями и успевает доморфиться.
+    float k = projScale / std::max(pixelError, 1e-3f);
+    float base = std::max(errors[1] * k, 3.0f * float(CDLOD_PATCH) * spacing);
+    // дальше диапазон удваивается вместе с узлом: на каждом уровне ~одно число
+    // узлов, т.е. треугольников ~ число уровней. Ошибка крупных уровней на
+    // экране может выйти за pixelError, если она растёт быстрее 2x на уровень.
+    for (int L = 0; L + 1 < levelCount; ++L) ranges[L] = base * float(1 << L);
+}
+
+bool CdlodTree::boxOf(int t, int nx, int nz, glm::vec3& lo, glm::vec3& hi) const {
+    const glm::vec2& m = minMax[t][size_t(nz) * tierSide(t) + nx];
+    if (m.x > m.y) return false;
+    int cells = (CDLOD_PATCH / 2) << t;
+    lo = glm::vec3(orgX + float(nx * cells) * spacing, m.x, orgZ + float(nz * cells) * spacing);
+    hi = glm::vec3(orgX + float(std::min(nx * cells + cells, gridW - 1)) * spacing, m.y,
+                   orgZ + float(std::min(nz * cells + cells, gridD - 1)) * spacing);
+    return true;
+}
+
+void CdlodTree::emit(int level, int nx, int nz, int quadrant, std::vector<CdlodQuad>& out) const {
+    const glm::vec2& m = minMax[level][size_t(2 * nz + (quadrant >> 1)) * tierSide(level) + 2 * nx + (quadrant & 1)];
+    if (m.x > m.y) return;  // четверть за краем сетки
+    int size = CDLOD_PATCH << level;
+    out.push_back({ level, nx * size, nz * size, size, quadrant });
+}
+
+// false — узел дальше своего диапазона: его место рисует родитель
+bool CdlodTree::selectNode(int level, int nx, int nz, const glm::vec3& eye, std::vector<CdlodQuad>& out) const {
+    glm::vec3 lo, hi;
+    if (!boxOf(level + 1, nx, nz, lo, hi)) return true;  // за краем сетки — рисовать нечего
+    float d2 = distanceSq(eye, lo, hi);
+    if (d2 > ranges[level] * ranges[level]) return false;
+
+    if (level == 0 || d2 > ranges[level - 1] * ranges[level - 1]) {
+        for (int q = 0; q < 4; ++q) emit(level, nx, nz, q, out);
+        return true;
+    }
+    // ближе диапазона детей: дети сами, а вышедших из своего диапазона — этот
+    // уровень, только их четвертью патча
+    for (int q = 0; q < 4; ++q)
+        if (!selectNode(level - 1, 2 * nx + (q & 1), 2 * nz + (q >> 1), eye, out))
+            emit(level, nx, nz, q, out);
+    return true;
+}
+
+void CdlodTree::select(const glm::vec3& eye, const Frustum& frustum, std::vector<CdlodQuad>& out) const {
+    out.clear();
+    if (!levelCount) return;
+    selectNode(levelCount - 1, 0, 0, eye, out);  // диапазон корня бесконечен
+
+    // отсечение выбранных четвертей по их AABB — пачками, тем же ядром, что тайлы
+    int n = int(out.size());
+    if (!n) return;
+    std::vector<float> bounds(size_t(n) * 6);
+    const float* boxes[6];
+    for (int k = 0; k < 6; ++k) boxes[k] = &bounds[size_t(k) * n];
+    for (int i = 0; i < n; ++i) {
+        const CdlodQuad& q = out[i];
+        glm::vec3 lo, hi;
+        boxOf(q.level, q.x0 / (q.size / 2) + (q.quadrant & 1), q.z0 / (q.size / 2) + (q.quadrant >> 1), lo, hi);
+        for (int k = 0; k < 3; ++k) {
+            bounds[size_t(k) * n + i] = lo[k];
+            bounds[size_t(k + 3) * n + i] = hi[k];
+        }
+    }
+    std::vector<uint8_t> visible(n);
+    cullBoxes(frustum, boxes, n, visible.data());
+    int kept = 0;
+    for (int i = 0; i < n; ++i)
+        if (visible[i]) out[kept++] = out[i];
+    out.resize(kept);
+}
+
+CdlodRenderer::~CdlodRenderer() {
+    if (!vao) return;
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+    glDeleteTextures(1, &heightTex);
+}
+
+void CdlodRenderer::createPatch() {
+    const int P = CDLOD_PATCH, V = P + 1, Q = P / 2;
+    std::vector<float> verts;
+    verts.reserve(size_t(V) * V * 2);
+    for (int z = 0; z < V; ++z)
+        for (int x = 0; x < V; ++x) verts.insert(verts.end(), { float(x), float(z) });
+
+    // индексы по четвертям подряд: четверть q — диапазон [q, q + 1) * Q * Q * 6,
+    // так родитель рисует только те четверти, что не взяли дети
+    std::vector<uint16_t> indices;
+    indices.reserve(size_t(P) * P * 6);
+    for (int q = 0; q < 4; ++q) {
+        int qx = (q & 1) * Q, qz = (q >> 1) * Q;
+        for (int z = qz; z < qz + Q; ++z) {
+            for (int x = qx; x < qx + Q; ++x) {
+                uint16_t i = uint16_t(z * V + x);
+                indices.insert(indices.end(), {
+                    i, uint16_t(i + 1), uint16_t(i + V),
+                    uint16_t(i + 1), uint16_t(i + V + 1), uint16_t(i + V)
+                    });
+            }
+        }
+    }
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glGenTextures(1, &heightTex);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);  // aGrid
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+}
+
+void CdlodRenderer::upload(const Heightfield& hf, ThreadPool& pool) {
+    if (!vao) createPatch();
+    int W = hf.width(), D = hf.depth();
+
+    // h, dh/dx, dh/dz в один texel: одна выборка на вершину
+    std::vector<float> texels(size_t(W) * D * 3);
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) {
+            const float* h = hf.row(z);
+            const float* gx = hf.gradXRow(z);
+            const float* gz = hf.gradZRow(z);
+            float* out = &texels[size_t(z) * W * 3];
+            for (int x = 0; x < W; ++x) {
+                out[3 * x] = h[x];
+                out[3 * x + 1] = gx[x];
+                out[3 * x + 2] = gz[x];
+            }
+        }
+        });
+
+    glBindTexture(GL_TEXTURE_2D, heightTex);
+    if (texWidth != W || texDepth != D) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, W, D, 0, GL_RGB, GL_FLOAT, texels.data());
+        texWidth = W;
+        texDepth = D;
+    }
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, W, D, GL_RGB, GL_FLOAT, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    lodTree.build(hf, pool);
+}
+
+void CdlodRenderer::select(const glm::vec3& eye, const glm::mat4& viewProjection, float pixelError, float projScale) {
+    if (!lodTree.levels()) return;
+    lodTree.setRanges(pixelError, projScale);
+    lodTree.select(eye, Frustum::fromMatrix(viewProjection), selection);
+}
+
+void CdlodRenderer::draw(const Shader& shader, const Heightfield& hf) const {
+    if (selection.empty()) return;
+    const int TEX_UNIT = 11;  // 0..10 — материалы terrain.frag
+    glActiveTexture(GL_TEXTURE0 + TEX_UNIT);
+    glBindTexture(GL_TEXTURE_2D, heightTex);
+    shader.setInt("heightMap", TEX_UNIT);
+    shader.setVec2("gridOrigin", glm::vec2(hf.originX(), hf.originZ()));
+    shader.setFloat("gridSpacing", hf.spacing());
+    shader.setVec2("gridNodes", glm::vec2(hf.width(), hf.depth()));
+
+    const GLsizei quadIndices = (CDLOD_PATCH / 2) * (CDLOD_PATCH / 2) * 6;
+    glBindVertexArray(vao);
+    int level = -1;
+    for (const CdlodQuad& q : selection) {
+        if (q.level != level) {
+            level = q.level;
+            float end = lodTree.range(level), prev = level ? lodTree.range(level - 1) : 0.0f;
+            // у корня диапазон бесконечен: start = FLT_MAX / 2 — morph всегда 0
+            float start = end == FLT_MAX ? 0.5f * FLT_MAX : prev + (end - prev) * MORPH_START;
+            shader.setVec2("morphRange", glm::vec2(start, end));
+            shader.setFloat("nodeScale", hf.spacing() * float(1 << level));
+        }
+        shader.setVec2("nodeOrigin", glm::vec2(hf.worldX(q.x0), hf.worldZ(q.z0)));
+        glDrawElements(GL_TRIANGLES, quadIndices, GL_UNSIGNED_SHORT,
+            (void*)(size_t(q.quadrant) * quadIndices * sizeof(uint16_t)));
+    }
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+}
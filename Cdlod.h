@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glad/glad.h>
+
+class Heightfield;
+class Shader;
+class ThreadPool;
+struct Frustum;
+
+// CDLOD (continuous distance-dependent LOD): квадродерево над сеткой высот.
+// Узел уровня L покрывает CDLOD_PATCH * 2^L ячеек и рисуется одним общим
+// патчем CDLOD_PATCH x CDLOD_PATCH с шагом 2^L узлов; высоты и градиенты
+// вершина берёт из текстуры. Уровень выбирается по расстоянию до камеры:
+// граница уровня 0 следует из геометрической ошибки уровня 1 и допустимой
+// ошибки в пикселях, дальше с каждым уровнем удваивается — поэтому
+// треугольников ~ число уровней (log размера сетки), а не площадь. У границы
+// уровня вершины плавно стягиваются к сетке родителя (geomorph в terrain.vert)
+// — без скачков.
+constexpr int CDLOD_PATCH = 32;
+
+// Четверть узла к отрисовке: узел уровня level с углом (x0, z0) и стороной
+// size ячеек, четверть quadrant (бит 0 — по x, бит 1 — по z)
+struct CdlodQuad {
+    int level;
+    int x0, z0, size;
+    int quadrant;
+};
+
+// CPU-часть: без GL, можно звать из тестов
+class CdlodTree {
+public:
+    // Мин/макс высоты узлов и ошибки уровней по сетке (параллельно по рядам)
+    void build(const Heightfield& hf, ThreadPool& pool);
+
+    // Границы уровней (после build — 1 px при 1080 рядах и fovY 45):
+    // уровень L рисуется до range(L). projScale — пикселей на
+    // единицу ширины на расстоянии 1 (высота вьюпорта / (2 tan(fovY / 2)))
+    void setRanges(float pixelError, float projScale);
+
+    // Четверти, покрывающие сетку без дыр и перекрытий, без тех, что вне пирамиды
+    void select(const glm::vec3& eye, const Frustum& frustum, std::vector<CdlodQuad>& out) const;
+
+    int   levels() const { return levelCount; }
+    float range(int level) const { return ranges[level]; }
+    // Наибольшее отклонение сетки с шагом 2^level узлов от полной
+    float levelError(int level) const { return errors[level]; }
+
+private:
+    int   gridW = 0, gridD = 0, rootSize = 0, levelCount = 0;
+    float spacing = 1.0f, orgX = 0.0f, orgZ = 0.0f;
+    // мин/макс по ярусам: ярус t — узлы по (CDLOD_PATCH / 2) << t ячеек,
+    // т.е. ярус L + 1 — узлы уровня L, ярус L — их четверти
+    std::vector<std::vector<glm::vec2>> minMax;
+    std::vector<float> errors, ranges;
+
+    int  tierSide(int t) const { return rootSize / ((CDLOD_PATCH / 2) << t); }
+    bool boxOf(int t, int nx, int nz, glm::vec3& lo, glm::vec3& hi) const;
+    bool selectNode(int level, int nx, int nz, const glm::vec3& eye, std::vector<CdlodQuad>& out) const;
+    void emit(int level, int nx, int nz, int quadrant, std::vector<CdlodQuad>& out) const;
+};
+
+// GL-часть: общий патч (вершины — координаты в патче, индексы по четвертям)
+// и текстура высот RGB32F (h, dh/dx, dh/dz)
+class CdlodRenderer {
+public:
+    ~CdlodRenderer();
+
+    // Текстура и дерево по сетке; GL-поток
+    void upload(const Heightfield& hf, ThreadPool& pool);
+    void select(const glm::vec3& eye, const glm::mat4& viewProjection, float pixelError, float projScale);
+    void draw(const Shader& shader, const Heightfield& hf) const;
+
+    const CdlodTree& tree() const { return lodTree; }
+    int quads() const { return int(selection.size()); }
+    size_t triangles() const { return selection.size() * (CDLOD_PATCH / 2) * (CDLOD_PATCH / 2) * 2; }
+
+private:
+    GLuint vao = 0, vbo = 0, ebo = 0, heightTex = 0;
+    int    texWidth = 0, texDepth = 0;
+    CdlodTree lodTree;
+    std::vector<CdlodQuad> selection;
+
+    void createPatch();
+};
@@ -0,0 +1,46 @@
+#pragma once
+// Отсечение AABB пирамидой видимости над типами из SimdTypes.h.
+// Подключается только из Simd*.cpp.
+#include "SimdTypes.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// Боксы пачками по 8 (AVX2 — один вектор, SSE — два, scalar — восемь).
+// Для каждой плоскости берётся угол бокса, дальше всех сдвинутый вдоль её
+// нормали (p-вершина): если и он снаружи, снаружи весь бокс. Ветвление —
+// только по знаку коэффициента плоскости, общего для всей пачки. Тест
+// консервативный: бокс у ребра пирамиды может пройти, не будучи видимым.
+// Хвост пачки добивается последним боксом.
+template<typename V>
+void frustumCull(const float* planes, const float* const* boxes, int count, uint8_t* visible) {
+    constexpr int B = 8, W = V::Width;
+    static_assert(B % W == 0, "batch must be a whole number of vectors");
+    float pad[6][B], dist[B];
+    for (int i0 = 0; i0 < count; i0 += B) {
+        int n = std::min(B, count - i0);
+        const float* box[6];
+        for (int k = 0; k < 6; ++k) {
+            if (n == B) { box[k] = boxes[k] + i0; continue; }
+            for (int j = 0; j < B; ++j) pad[k][j] = boxes[k][i0 + std::min(j, n - 1)];
+            box[k] = pad[k];
+        }
+        for (int j = 0; j < B; j += W) {
+            V d = V::set1(0.0f);
+            for (int p = 0; p < 6; ++p) {
+                const float* pl = planes + 4 * p;
+                // boxes: minX, minY, minZ, maxX, maxY, maxZ
+                V x = V::load(box[pl[0] >= 0.0f ? 3 : 0] + j);
+                V y = V::load(box[pl[1] >= 0.0f ? 4 : 1] + j);
+                V z = V::load(box[pl[2] >= 0.0f ? 5 : 2] + j);
+                V e = x * V::set1(pl[0]) + y * V::set1(pl[1]) + z * V::set1(pl[2]) + V::set1(pl[3]);
+                d = p == 0 ? e : vmin(d, e);
+            }
+            d.store(dist + j);
+        }
+        for (int j = 0; j < n; ++j) visible[i0 + j] = dist[j] >= 0.0f;
+    }
+}
+
+} // namespace
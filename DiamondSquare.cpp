@@ -0,0 +1,168 @@
+#include "DiamondSquare.h"
+#include "Heightfield.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+// Окно квадрата: узел (x, z) в координатах всего квадрата
+struct GridView {
+    float* v;
+    int    x0, z0, stride;
+    float& at(int x, int z) const { return v[size_t(z - z0) * stride + (x - x0)]; }
+};
+
+// Уровень: шаг s (сторона квадратов), смещение — до ±scale
+struct Level {
+    int      S, s;
+    float    scale;
+    uint32_t seed;
+};
+
+// [-1, 1): целочисленный хеш узла
+float displacement(int x, int z, uint32_t seed) {
+    uint32_t h = uint32_t(x) * 0x8DA6B343u ^ uint32_t(z) * 0xD8163841u ^ seed * 0xCB1AB31Fu;
+    h ^= h >> 16; h *= 0x7FEB352Du;
+    h ^= h >> 15; h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return float(h >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+// Первый x >= a (a >= 0) с x % s == r
+int firstAt(int a, int r, int s) { return a <= r ? r : r + (a - r + s - 1) / s * s; }
+
+float levelScale(int S, int s, float roughness) {
+    int k = 0;
+    for (int t = S - 1; t > s; t /= 2) ++k;
+    return std::pow(roughness, float(k));
+}
+
+// Diamond: центры квадратов уровня в [xa, xb] x [za, zb]
+void diamondPass(const GridView& g, const Level& L, int xa, int xb, int za, int zb) {
+    int h = L.s / 2, s = L.s;
+    size_t dz = size_t(h) * g.stride;
+    xa = firstAt(std::max(xa, 0), h, s); za = std::max(za, 0);
+    xb = std::min(xb, L.S - 1); zb = std::min(zb, L.S - 1);
+    for (int z = firstAt(za, h, s); z <= zb; z += s) {
+        float* c = &g.at(xa, z);
+        for (int x = xa; x <= xb; x += s, c += s)
+            *c = 0.25f * (c[-ptrdiff_t(dz) - h] + c[-ptrdiff_t(dz) + h] + c[dz - h] + c[dz + h]) +
+                 displacement(x, z, L.seed) * L.scale;
+    }
+}
+
+// Square: середины рёбер; соседей за краем квадрата нет — среднее по трём.
+// Внутри сетки n = 4, и sum / 4 == sum * 0.25 побитово.
+void squarePass(const GridView& g, const Level& L, int xa, int xb, int za, int zb) {
+    int h = L.s / 2, s = L.s;
+    size_t dz = size_t(h) * g.stride;
+    xa = std::max(xa, 0); za = std::max(za, 0);
+    xb = std::min(xb, L.S - 1); zb = std::min(zb, L.S - 1);
+    for (int z = firstAt(za, 0, h); z <= zb; z += h) {
+        int x = firstAt(xa, z % s == 0 ? h : 0, s);
+        bool inner = z >= h && z + h < L.S;
+        float* c = &g.at(x, z);
+        for (; x <= xb; x += s, c += s) {
+            float avg;
+            if (inner && x >= h && x + h < L.S)
+                avg = (c[-h] + c[h] + c[-ptrdiff_t(dz)] + c[dz]) * 0.25f;
+            else {
+                float sum = 0.0f;
+                int n = 0;
+                if (x >= h)      { sum += c[-h]; ++n; }
+                if (x + h < L.S) { sum += c[h]; ++n; }
+                if (z >= h)      { sum += c[-ptrdiff_t(dz)]; ++n; }
+                if (z + h < L.S) { sum += c[dz]; ++n; }
+                avg = sum / float(n);
+            }
+            *c = avg + displacement(x, z, L.seed) * L.scale;
+        }
+    }
+}
+
+} // namespace
+
+bool diamondSquareField(Heightfield& hf, const DiamondSquareParams& p, ThreadPool& pool,
+                        const std::atomic<bool>* cancel) {
+    int W = hf.width(), D = hf.depth();
+    int S = 3;
+    while (S < std::max(W, D)) S = 2 * S - 1;
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+
+    // сетка ровно 2^k + 1 — считаем прямо в ней
+    std::vector<float> temp;
+    if (W != S || D != S) temp.resize(size_t(S) * S);
+    GridView grid{ temp.empty() ? hf.data() : temp.data(), 0, 0, S };
+
+    for (int z = 0; z < S; z += S - 1)
+        for (int x = 0; x < S; x += S - 1) grid.at(x, z) = displacement(x, z, p.seed);
+
+    int T = 1;
+    if (p.blockSize > 1)
+        while (T * 2 <= std::min(p.blockSize, S - 1)) T *= 2;
+
+    // 1) крупные уровни по всей сетке: мало узлов, параллельно по рядам уровня
+    for (int s = S - 1; s > T && s >= 2; s /= 2) {
+        Level L{ S, s, levelScale(S, s, p.roughness), p.seed };
+        int h = s / 2, n = (S - 1) / s;
+        pool.parallelFor(0, n, std::max(1, 16384 / n), [&](int j0, int j1) {
+            diamondPass(grid, L, 0, S - 1, h + j0 * s, h + (j1 - 1) * s);
+            });
+        pool.parallelFor(0, 2 * n + 1, std::max(1, 16384 / (n + 1)), [&](int j0, int j1) {
+            squarePass(grid, L, 0, S - 1, j0 * h, (j1 - 1) * h);
+            });
+        if (cancelled()) return false;
+    }
+
+    // 2) мелкие уровни (шаг <= T) — блоками T x T до конца, прямо в сетке.
+    //    Блок досчитывает и кайму: узлы уровня s в пределах need(s) от блока,
+    //    need(2) = 0, need(2s) = need(s) + s, т.е. до 1.5T в соседние блоки.
+    //    Кайма совпадает побитово с тем, что посчитает сосед, но чтобы не
+    //    писать одновременно, блоки идут 9 фазами: в фазе соседей по 3.
+    if (T >= 2) {
+        int nt = (S - 1) / T, nc = (nt + 2) / 3;
+        for (int phase = 0; phase < 9; ++phase) {
+            int px = phase % 3, pz = phase / 3;
+            pool.parallelFor(0, nc * nc, std::max(1, 16384 / (T * T)), [&](int b0, int b1) {
+                if (cancelled()) return;
+                for (int b = b0; b < b1; ++b) {
+                    int tx = (b % nc) * 3 + px, tz = (b / nc) * 3 + pz;
+                    if (tx >= nt || tz >= nt) continue;
+                    int x0 = tx * T, z0 = tz * T, need = T - 2;
+                    for (int s = T; s >= 2; s /= 2) {
+                        Level L{ S, s, levelScale(S, s, p.roughness), p.seed };
+                        int h = s / 2;
+                        diamondPass(grid, L, x0 - need - h, x0 + T + need + h, z0 - need - h, z0 + T + need + h);
+                        squarePass(grid, L, x0 - need, x0 + T + need, z0 - need, z0 + T + need);
+                        need -= h;
+                    }
+                }
+                });
+            if (cancelled()) return false;
+        }
+    }
+
+    // 3) к [-1, 1] по видимой части (она же обрезка до W x D)
+    std::vector<float> lo(D), hi(D);
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) {
+            const float* r = &grid.at(0, z);
+            auto mm = std::minmax_element(r, r + W);
+            lo[z] = *mm.first;
+            hi[z] = *mm.second;
+        }
+        });
+    float mn = *std::min_element(lo.begin(), lo.end()), mx = *std::max_element(hi.begin(), hi.end());
+    float mid = 0.5f * (mn + mx), inv = mx > mn ? 2.0f / (mx - mn) : 0.0f;
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) {
+            const float* src = &grid.at(0, z);
+            float* dst = hf.row(z);
+            for (int x = 0; x < W; ++x) dst[x] = (src[x] - mid) * inv;
+        }
+        });
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+class Heightfield;
+class ThreadPool;
+
+// Diamond-square (midpoint displacement): дешёвый фрактал для превью и
+// быстрой фоновой заливки тайлов. Считается на квадрате (2^k + 1)^2,
+// покрывающем сетку, и обрезается до её размера.
+struct DiamondSquareParams {
+    float    roughness = 0.5f;  // множитель смещения на уровень (0.5 ~ fBm с H = 1)
+    uint32_t seed = 0;
+    // Сторона блока (степень двойки): уровни с шагом <= blockSize доделываются
+    // внутри блока за один проход по его памяти. 0 — по учебнику: каждый
+    // уровень — два прохода (diamond, square) по всей сетке.
+    int      blockSize = 64;
+};
+
+// Смещение узла — хеш (x, z, seed), а не общий генератор, поэтому результат
+// не зависит от порядка обхода, числа потоков и blockSize (побитово).
+// Крупные уровни — параллельно по рядам уровня, мелкие — по блокам; узлы
+// каймы у соседних блоков блок досчитывает сам, так что блоки друг друга не
+// ждут. Значения приводятся к [-1, 1].
+bool diamondSquareField(Heightfield& hf, const DiamondSquareParams& p, ThreadPool& pool,
+                        const std::atomic<bool>* cancel = nullptr);
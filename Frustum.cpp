@@ -0,0 +1,29 @@
+#include "Frustum.h"
+#include "Simd.h"
+
+Frustum Frustum::fromMatrix(const glm::mat4& m) {
+    // glm хранит по столбцам: строка i — (m[0][i], m[1][i], m[2][i], m[3][i]).
+    // В double: у дальней плоскости r3 - r2 почти сокращается (near << far),
+    // и во float она уезжала на десятые доли единицы
+    auto row = [&m](int i) { return glm::dvec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+    glm::dvec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+    const glm::dvec4 planes[6] = {
+        r3 + r0, r3 - r0,   // -w <= x <= w
+        r3 + r1, r3 - r1,
+        r3 + r2, r3 - r2,   // OpenGL: -w <= z <= w
+    };
+    Frustum f;
+    for (int i = 0; i < 6; ++i) {
+        double len = glm::length(glm::dvec3(planes[i]));
+        f.planes[i] = glm::vec4(len > 0.0 ? planes[i] / len : planes[i]);
+    }
+    return f;
+}
+
+int cullBoxes(const Frustum& f, const float* const* boxes, int count, uint8_t* visible) {
+    if (count <= 0) return 0;
+    simdKernels().frustumCull(&f.planes[0].x, boxes, count, visible);
+    int n = 0;
+    for (int i = 0; i < count; ++i) n += visible[i];
+    return n;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Пирамида видимости: 6 плоскостей (a, b, c, d), внутри a*x + b*y + c*z + d >= 0.
+// Нормали единичные — d и расстояния в мировых единицах.
+struct Frustum {
+    glm::vec4 planes[6];  // left, right, bottom, top, near, far
+
+    // Из projection * view (* model), по строкам матрицы (Gribb, Hartmann):
+    // плоскости — в координатах, к которым применяется матрица
+    static Frustum fromMatrix(const glm::mat4& m);
+};
+
+// visible[i] = AABB i хотя бы частично в пирамиде; пачками по 8 боксов
+// ядром активного уровня SIMD (SimdKernels::frustumCull). boxes — SoA:
+// minX, minY, minZ, maxX, maxY, maxZ по count чисел. Возвращает число видимых.
+int cullBoxes(const Frustum& f, const float* const* boxes, int count, uint8_t* visible);
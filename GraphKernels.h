@@ -0,0 +1,131 @@
+#pragma once
+// Интерпретатор NoiseProgram над типами из SimdTypes.h.
+// Подключается только из Simd*.cpp, после NoiseKernels.h.
+#include "NoiseGraph.h"
+#include "NoiseKernels.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+template<typename V>
+inline void fractalBlock(const FbmParams& p, const float* x, const float* z, int n, float* out) {
+    switch (p.basis) {
+    case NoiseBasis::GlmPerlin: fbmKernel<GlmPerlinBasis, V>(p, x, z, n, out, nullptr, nullptr); break;
+    case NoiseBasis::Simplex:   fbmKernel<SimplexBasis, V>(p, x, z, n, out, nullptr, nullptr); break;
+    default:                    fbmKernel<SeededPerlinBasis, V>(p, x, z, n, out, nullptr, nullptr); break;
+    }
+}
+
+// Кусочно-линейная кривая без ветвлений по точкам:
+// y = y0 + sum clamp((a - x_i) / (x_{i+1} - x_i), 0, 1) * (y_{i+1} - y_i)
+template<typename V>
+inline V curveEval(V a, const float* pts, int count) {
+    const V zero = vconst<V>(0.0f), one = vconst<V>(1.0f);
+    V y = vconst<V>(pts[1]);
+    for (int i = 0; i + 1 < count; ++i) {
+        float x0 = pts[2 * i], y0 = pts[2 * i + 1], x1 = pts[2 * i + 2], y1 = pts[2 * i + 3];
+        V t = x1 > x0 ? vmin(vmax((a - vconst<V>(x0)) * vconst<V>(1.0f / (x1 - x0)), zero), one)
+                      : vselect(vlt(a, vconst<V>(x0)), zero, one);   // вертикальный скачок
+        y = y + t * vconst<V>(y1 - y0);
+    }
+    return y;
+}
+
+// Ступени: площадка на доле (1 - slope) ступени, затем линейный подъём
+template<typename V>
+inline V terraceEval(V a, float steps, float slope) {
+    V t = a * vconst<V>(steps), f = vfloor(t);
+    V u = (t - f - vconst<V>(1.0f - slope)) * vconst<V>(1.0f / slope);
+    u = vmin(vmax(u, vconst<V>(0.0f)), vconst<V>(1.0f));
+    return (f + u) * vconst<V>(1.0f / steps);
+}
+
+// Блоки по NOISE_PROGRAM_BLOCK точек; хвост блока считается целыми векторами
+// (лишние дорожки регистров содержат старые конечные значения и не выводятся)
+template<typename V>
+void runProgram(const NoiseProgram& prog, const float* x, const float* z, int count, float* out,
+                const float* const* loads, float* const* stores) {
+    constexpr int W = V::Width, B = NOISE_PROGRAM_BLOCK;
+    static_assert(B % W == 0, "block must be a whole number of vectors");
+    thread_local std::vector<float> regs;
+    size_t need = size_t(prog.registers) * B;
+    if (regs.size() < need) regs.resize(need, 0.0f);
+    auto R = [&](int r) { return regs.data() + size_t(r) * B; };
+
+    for (int i0 = 0; i0 < count; i0 += B) {
+        int n = std::min(B, count - i0), nv = (n + W - 1) / W * W;
+        std::copy(x + i0, x + i0 + n, R(0));
+        std::copy(z + i0, z + i0 + n, R(1));
+        for (const NoiseInstr& in : prog.code) {
+            float* d = in.dst >= 0 ? R(in.dst) : nullptr;
+            const float* a = in.a >= 0 ? R(in.a) : nullptr;
+            const float* b = in.b >= 0 ? R(in.b) : nullptr;
+            const float* c = in.c >= 0 ? R(in.c) : nullptr;
+            switch (in.op) {
+            case NoiseOp::Const: {
+                V k = vconst<V>(in.k0);
+                for (int i = 0; i < nv; i += W) k.store(d + i);
+                break;
+            }
+            case NoiseOp::Fractal:
+                fractalBlock<V>(prog.fractals[in.param], a, b, n, d);
+                break;
+            case NoiseOp::Cellular:
+                worleyKernel<V>(prog.cellular[in.param], a, b, n, d);
+                break;
+            case NoiseOp::Add:
+                for (int i = 0; i < nv; i += W) (V::load(a + i) + V::load(b + i)).store(d + i);
+                break;
+            case NoiseOp::Sub:
+                for (int i = 0; i < nv; i += W) (V::load(a + i) - V::load(b + i)).store(d + i);
+                break;
+            case NoiseOp::Mul:
+                for (int i = 0; i < nv; i += W) (V::load(a + i) * V::load(b + i)).store(d + i);
+                break;
+            case NoiseOp::Min:
+                for (int i = 0; i < nv; i += W) vmin(V::load(a + i), V::load(b + i)).store(d + i);
+                break;
+            case NoiseOp::Max:
+                for (int i = 0; i < nv; i += W) vmax(V::load(a + i), V::load(b + i)).store(d + i);
+                break;
+            case NoiseOp::Affine: {
+                V s = vconst<V>(in.k0), o = vconst<V>(in.k1);
+                for (int i = 0; i < nv; i += W) (V::load(a + i) * s + o).store(d + i);
+                break;
+            }
+            case NoiseOp::Clamp: {
+                V lo = vconst<V>(in.k0), hi = vconst<V>(in.k1);
+                for (int i = 0; i < nv; i += W) vmin(vmax(V::load(a + i), lo), hi).store(d + i);
+                break;
+            }
+            case NoiseOp::Blend:
+                for (int i = 0; i < nv; i += W) {
+                    V va = V::load(a + i);
+                    (va + (V::load(b + i) - va) * V::load(c + i)).store(d + i);
+                }
+                break;
+            case NoiseOp::Curve: {
+                const float* pts = prog.consts.data() + in.param;
+                for (int i = 0; i < nv; i += W) curveEval(V::load(a + i), pts, in.count).store(d + i);
+                break;
+            }
+            case NoiseOp::Terrace:
+                for (int i = 0; i < nv; i += W) terraceEval(V::load(a + i), in.k0, in.k1).store(d + i);
+                break;
+            case NoiseOp::Load:
+                std::copy(loads[in.param] + i0, loads[in.param] + i0 + n, d);
+                break;
+            case NoiseOp::Store:
+                std::copy(a, a + n, stores[in.param] + i0);
+                break;
+            default:
+                break;
+            }
+        }
+        const float* r = R(prog.output);
+        std::copy(r, r + n, out + i0);
+    }
+}
+
+} // namespace
@@ -0,0 +1,48 @@
+#pragma once
+// Шаблонные ядра по сетке высот над типами из SimdTypes.h.
+// Подключается только из Simd*.cpp.
+#include "SimdTypes.h"
+
+namespace {
+
+// Центральные разности для одного ряда: gz = (next - prev) * scaleZ для всех x,
+// gx = (h[x+1] - h[x-1]) * scaleX внутри, односторонние разности на краях.
+// Каждая точка пишется один раз, читаются только соседи — ряды независимы.
+template<typename V>
+void gradientRow(const float* prev, const float* row, const float* next, int width,
+                 float scaleX, float scaleZ, float* gx, float* gz) {
+    constexpr int W = V::Width;
+    const V sz = V::set1(scaleZ), sx = V::set1(scaleX);
+    int x = 0;
+    for (; x + W <= width; x += W)
+        ((V::load(next + x) - V::load(prev + x)) * sz).store(gz + x);
+    for (; x < width; ++x)
+        gz[x] = (next[x] - prev[x]) * scaleZ;
+
+    if (width < 2) { if (width == 1) gx[0] = 0.0f; return; }
+    x = 1;
+    for (; x + W <= width - 1; x += W)
+        ((V::load(row + x + 1) - V::load(row + x - 1)) * sx).store(gx + x);
+    for (; x < width - 1; ++x)
+        gx[x] = (row[x + 1] - row[x - 1]) * scaleX;
+    gx[0] = (row[1] - row[0]) * (2.0f * scaleX);
+    gx[width - 1] = (row[width - 1] - row[width - 2]) * (2.0f * scaleX);
+}
+
+// Вертикальный проход бикубического апсемплинга с накоплением:
+// out[x] += w[0]*r0[x] + w[1]*r1[x] + w[2]*r2[x] + w[3]*r3[x]
+template<typename V>
+void cubicBlendRow(const float* r0, const float* r1, const float* r2, const float* r3,
+                   const float* w, int width, float* out) {
+    constexpr int W = V::Width;
+    const V w0 = V::set1(w[0]), w1 = V::set1(w[1]), w2 = V::set1(w[2]), w3 = V::set1(w[3]);
+    int x = 0;
+    for (; x + W <= width; x += W) {
+        V s = w0 * V::load(r0 + x) + w1 * V::load(r1 + x) + w2 * V::load(r2 + x) + w3 * V::load(r3 + x);
+        (V::load(out + x) + s).store(out + x);
+    }
+    for (; x < width; ++x)
+        out[x] += w[0] * r0[x] + w[1] * r1[x] + w[2] * r2[x] + w[3] * r3[x];
+}
+
+} // namespace
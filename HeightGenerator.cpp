@@ -0,0 +1,513 @@
+#include "HeightGenerator.h"
+#include "DiamondSquare.h"
+#include "Heightfield.h"
+#include "NoiseGraph.h"
+#include "ThreadPool.h"
+#include "Spectral.h"
+#include "Simd.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+// h = (n*0.5+0.5)^2 * A; gx/gz (если есть) — из dfbm в dh по цепному правилу
+static void shapeRow(float* row, float* gx, float* gz, int W, float amplitude) {
+    for (int x = 0; x < W; ++x) {
+        float n = row[x] * 0.5f + 0.5f;
+        row[x] = std::pow(n, 2.0f) * amplitude;
+        if (gx) {
+            // d/dx (n^2 * A) = 2n * 0.5 * dfbm/dx * A
+            float k = n * amplitude;
+            gx[x] *= k;
+            gz[x] *= k;
+        }
+    }
+}
+
+// Общая часть статистики: сколько октав просили и сколько отсекли
+static void beginStats(GenerationStats* stats, const FbmParams& fbm) {
+    if (!stats) return;
+    *stats = GenerationStats{};
+    stats->octavesRequested = fbm.normOctaves > 0 ? fbm.normOctaves : fbm.octaves;
+    stats->octavesSkipped = stats->octavesRequested - fbm.octaves;
+}
+
+bool generateFbmHeights(Heightfield& hf, const FbmParams& params, float amplitude, ThreadPool& pool,
+                        bool withGradients, const std::atomic<bool>* cancel,
+                        GenerationStats* stats) {
+    const FbmParams fbm = fbmWithTables(params);
+    int W = hf.width(), D = hf.depth();
+    if (withGradients) hf.allocGradients(); else hf.dropGradients();
+
+    // x-координаты одинаковы для всех рядов, z — константа внутри ряда
+    std::vector<float> xs(W);
+    for (int x = 0; x < W; ++x) xs[x] = hf.worldX(x);
+
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        if (cancelled()) return;
+        std::vector<float> zs(W);
+        for (int z = z0; z < z1; ++z) {
+            std::fill(zs.begin(), zs.end(), hf.worldZ(z));
+
+            // Perlin noise (батч на весь ряд, SIMD)
+            float* row = hf.row(z);
+            float* gx = withGradients ? hf.gradXRow(z) : nullptr;
+            float* gz = withGradients ? hf.gradZRow(z) : nullptr;
+            fbmBatch(fbm, xs.data(), zs.data(), W, row, gx, gz);
+            shapeRow(row, gx, gz, W, amplitude);
+        }
+        });
+    if (cancelled()) return false;
+
+    hf.updateBounds(pool);
+    beginStats(stats, fbm);
+    if (stats) {
+        stats->octavesEvaluated = fbm.octaves;
+        stats->noiseEvaluations = hf.size() * size_t(fbm.octaves);
+    }
+    return true;
+}
+
+// Максимальная погрешность Catmull-Rom по одной октаве шума Перлина при шаге
+// rho периодов решётки: ~4.2 * rho^3 (замерено для rho <= 0.5)
+static float cubicNoiseError(float rho) { return 4.2f * rho * rho * rho; }
+
+// Веса Catmull-Rom для узлов -1, 0, 1, 2 при доле t между 0 и 1
+static void catmullRomWeights(float t, float w[4]) {
+    float t2 = t * t, t3 = t2 * t;
+    w[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+    w[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+    w[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+    w[3] = 0.5f * (t3 - t2);
+}
+
+bool generateFbmHeightsMultiRes(Heightfield& hf, const FbmParams& params, float amplitude,
+                                ThreadPool& pool, float tolerance,
+                                const std::atomic<bool>* cancel, GenerationStats* stats) {
+    // оценка погрешности — для гладкой суммы октав без сдвига; у остальных форм изломы
+    if (params.fractal != FractalType::Fbm || params.warpStrength != 0.0f)
+        return generateFbmHeights(hf, params, amplitude, pool, false, cancel, stats);
+    const FbmParams fbm = fbmWithTables(params);
+    const int maxLevel = 8;
+    int W = hf.width(), D = hf.depth(), K = fbm.octaves;
+    hf.dropGradients();
+    std::fill(hf.data(), hf.data() + hf.size(), 0.0f);
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+    const SimdKernels& k = simdKernels();
+    size_t evals = 0;
+
+    // уровень для каждой октавы: чем выше частота, тем мельче сетка,
+    // поэтому октавы с L = 0 идут сплошным хвостом [direct, K)
+    float maxA = fbmNormalization(fbm), freq = fbm.frequency, amp = 1.0f;
+    float perOctave = tolerance * maxA / float(K > 0 ? K : 1);
+    int direct = K;
+    std::vector<int> level(K, 0);
+    for (int o = 0; o < K; ++o) {
+        float a = o == K - 1 ? amp * fbm.lastWeight : amp;
+        int L = 0;
+        while (L < maxLevel && ((W - 1) >> (L + 1)) >= 1 && ((D - 1) >> (L + 1)) >= 1 &&
+               a * cubicNoiseError(hf.spacing() * float(1 << (L + 1)) * freq) <= perOctave)
+            ++L;
+        level[o] = L;
+        if (L == 0 && direct == K) direct = o;
+        freq *= 2;
+        amp *= 0.5f;
+    }
+
+    // 1) низкие октавы: редкая сетка -> бикубика по x -> бикубика по z с накоплением
+    std::vector<float> coarse, expanded;
+    for (int o = 0; o < direct; ++o) {
+        int L = level[o], f = 1 << L;
+        // узел j редкой сетки лежит на мелком индексе (j - 1) * f: слева один
+        // запасной узел, справа два — под 4 отвода фильтра
+        int Wc = ((W - 1) >> L) + 4, Dc = ((D - 1) >> L) + 4;
+        coarse.assign(size_t(Wc) * Dc, 0.0f);
+        expanded.resize(size_t(W) * Dc);
+        std::vector<float> xc(Wc);
+        for (int j = 0; j < Wc; ++j) xc[j] = hf.originX() + float((j - 1) * f) * hf.spacing();
+        std::vector<float> w(size_t(f) * 4);
+        for (int p = 0; p < f; ++p) catmullRomWeights(float(p) / f, &w[size_t(p) * 4]);
+
+        FbmParams layer = fbm;
+        layer.firstOctave = o;
+        layer.octaves = o + 1;
+        layer.lastWeight = o == K - 1 ? fbm.lastWeight : 1.0f;
+        pool.parallelFor(0, Dc, rowBand(Wc), [&](int j0, int j1) {
+            if (cancelled()) return;
+            std::vector<float> zs(Wc);
+            for (int j = j0; j < j1; ++j) {
+                std::fill(zs.begin(), zs.end(), hf.originZ() + float((j - 1) * f) * hf.spacing());
+                float* c = &coarse[size_t(j) * Wc];
+                fbmAccumulate(layer, xc.data(), zs.data(), Wc, c);
+                float* e = &expanded[size_t(j) * W];
+                for (int x = 0; x < W; ++x) {
+                    const float* t = c + (x >> L);
+                    const float* wp = &w[size_t(x & (f - 1)) * 4];
+                    e[x] = wp[0] * t[0] + wp[1] * t[1] + wp[2] * t[2] + wp[3] * t[3];
+                }
+            }
+            });
+        pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+            if (cancelled()) return;
+            for (int z = z0; z < z1; ++z) {
+                const float* e = &expanded[size_t(z >> L) * W];
+                k.cubicBlendRow(e, e + W, e + 2 * W, e + 3 * W, &w[size_t(z & (f - 1)) * 4], W, hf.row(z));
+            }
+            });
+        if (cancelled()) return false;
+        evals += size_t(Wc) * Dc;
+    }
+
+    // 2) высокие октавы — по узлам, одним проходом, затем нормировка и форма
+    std::vector<float> xs(W);
+    for (int x = 0; x < W; ++x) xs[x] = hf.worldX(x);
+    FbmParams high = fbm;
+    high.firstOctave = direct;
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        if (cancelled()) return;
+        std::vector<float> zs(W);
+        for (int z = z0; z < z1; ++z) {
+            float* row = hf.row(z);
+            if (direct < K) {
+                std::fill(zs.begin(), zs.end(), hf.worldZ(z));
+                fbmAccumulate(high, xs.data(), zs.data(), W, row);
+            }
+            for (int x = 0; x < W; ++x) row[x] = row[x] / maxA;
+            shapeRow(row, nullptr, nullptr, W, amplitude);
+        }
+        });
+    if (cancelled()) return false;
+    evals += size_t(W) * D * size_t(K - direct);
+
+    hf.updateBounds(pool);
+    beginStats(stats, fbm);
+    if (stats) {
+        stats->octavesEvaluated = K;
+        stats->noiseEvaluations = evals;
+    }
+    return true;
+}
+
+bool generateGraphHeights(Heightfield& hf, const NoiseProgram& prog, ThreadPool& pool,
+                          const std::atomic<bool>* cancel, GenerationStats* stats) {
+    int W = hf.width(), D = hf.depth();
+    hf.dropGradients();
+    std::vector<float> xs(W);
+    for (int x = 0; x < W; ++x) xs[x] = hf.worldX(x);
+
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        if (cancelled()) return;
+        std::vector<float> zs(W);
+        for (int z = z0; z < z1; ++z) {
+            std::fill(zs.begin(), zs.end(), hf.worldZ(z));
+            prog.run(xs.data(), zs.data(), W, hf.row(z));
+        }
+        });
+    if (cancelled()) return false;
+
+    hf.updateBounds(pool);
+    if (stats) {
+        *stats = GenerationStats{};
+        stats->octavesRequested = stats->octavesEvaluated = prog.octavesPerSample();
+        stats->noiseEvaluations = hf.size() * size_t(prog.octavesPerSample());
+    }
+    return true;
+}
+
+bool generateSpectralHeights(Heightfield& hf, const SpectralParams& sp, float amplitude,
+                             ThreadPool& pool, const std::atomic<bool>* cancel,
+                             GenerationStats* stats) {
+    hf.dropGradients();
+    if (!spectralField(hf, sp, pool, cancel)) return false;
+
+    int W = hf.width(), D = hf.depth();
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) shapeRow(hf.row(z), nullptr, nullptr, W, amplitude);
+        });
+    hf.updateBounds(pool);
+    if (stats) *stats = GenerationStats{};
+    return true;
+}
+
+bool generateDiamondSquareHeights(Heightfield& hf, const DiamondSquareParams& dp, float amplitude,
+                                  ThreadPool& pool, const std::atomic<bool>* cancel,
+                                  GenerationStats* stats) {
+    hf.dropGradients();
+    if (!diamondSquareField(hf, dp, pool, cancel)) return false;
+
+    int W = hf.width(), D = hf.depth();
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) shapeRow(hf.row(z), nullptr, nullptr, W, amplitude);
+        });
+    hf.updateBounds(pool);
+    if (stats) *stats = GenerationStats{};
+    return true;
+}
+
+bool FbmFieldCache::generate(Heightfield& hf, const FbmParams& params, float amplitude, ThreadPool& pool,
+                             const std::atomic<bool>* cancel, GenerationStats* stats) {
+    // у ridged/hybrid октавы зависят от предыдущих, warping сдвигает все — префиксов нет
+    if (!fbmAdditive(params))
+        return generateFbmHeights(hf, params, amplitude, pool, true, cancel, stats);
+    const FbmParams fbm = fbmWithTables(params);
+    int W_ = hf.width(), D_ = hf.depth();
+    size_t count = size_t(W_) * D_;
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+
+    // другая сетка, базис, сид, частота или смещение — все суммы недействительны
+    if (W_ != W || D_ != D || hf.spacing() != step || hf.originX() != orgX ||
+        hf.originZ() != orgZ || fbm.frequency != frequency || fbm.offset != offset ||
+        fbm.basis != basis || fbm.seed != seed || fbm.fractal != fractal) {
+        prefixes.clear();
+        W = W_; D = D_;
+        step = hf.spacing(); orgX = hf.originX(); orgZ = hf.originZ();
+        frequency = fbm.frequency; offset = fbm.offset;
+        basis = fbm.basis; seed = fbm.seed; fractal = fbm.fractal;
+    }
+
+    // готовая сумма (K, вес) или ближайшая полная сумма с меньшим числом октав
+    int K = fbm.octaves, k = 0;
+    Sums cur;
+    auto it = prefixes.find({ K, fbm.lastWeight });
+    if (it == prefixes.end())
+        for (auto i = prefixes.begin(); i != prefixes.end() && i->first.first < K; ++i)
+            if (i->first.second == 1.0f) it = i;
+    if (it != prefixes.end()) {
+        k = it->first.first;
+        cur = it->second;
+    }
+    else {
+        cur.n.assign(count, 0.0f);
+        cur.dx.assign(count, 0.0f);
+        cur.dz.assign(count, 0.0f);
+    }
+    beginStats(stats, fbm);
+    if (stats) {
+        stats->octavesEvaluated = K - k;
+        stats->noiseEvaluations = count * size_t(K - k);
+    }
+
+    // недостающие октавы — по одной, каждую промежуточную сумму запоминаем
+    std::vector<float> xs(W);
+    for (int x = 0; x < W; ++x) xs[x] = hf.worldX(x);
+    size_t sumsBytes = count * 3 * sizeof(float);
+    for (int o = k; o < K; ++o) {
+        FbmParams layer = fbm;
+        layer.firstOctave = o;
+        layer.octaves = o + 1;
+        layer.lastWeight = o == K - 1 ? fbm.lastWeight : 1.0f;
+        pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+            if (cancelled()) return;
+            std::vector<float> zs(W);
+            for (int z = z0; z < z1; ++z) {
+                std::fill(zs.begin(), zs.end(), hf.worldZ(z));
+                size_t r = size_t(z) * W;
+                fbmAccumulate(layer, xs.data(), zs.data(), W,
+                    &cur.n[r], &cur.dx[r], &cur.dz[r]);
+            }
+            });
+        if (cancelled()) return false;  // недописанная сумма в кэш не попадает
+        if (o + 1 < K && (prefixes.size() + 2) * sumsBytes <= budget)
+            prefixes[{ o + 1, 1.0f }] = cur;
+    }
+
+    // нормировка и форма — как в generateFbmHeights
+    hf.allocGradients();
+    float maxA = fbmNormalization(fbm);
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) {
+            size_t r = size_t(z) * W;
+            float* row = hf.row(z);
+            float* gx = hf.gradXRow(z);
+            float* gz = hf.gradZRow(z);
+            for (int x = 0; x < W; ++x) {
+                row[x] = cur.n[r + x] / maxA;
+                gx[x] = cur.dx[r + x] / maxA;
+                gz[x] = cur.dz[r + x] / maxA;
+            }
+            shapeRow(row, gx, gz, W, amplitude);
+        }
+        });
+    hf.updateBounds(pool);
+
+    if (sumsBytes <= budget) {
+        prefixes[{ K, fbm.lastWeight }] = std::move(cur);
+        trim(K);
+    }
+    return true;
+}
+
+void FbmFieldCache::setBudget(size_t bytes) {
+    budget = bytes;
+    trim(prefixes.empty() ? 0 : prefixes.rbegin()->first.first);
+}
+
+size_t FbmFieldCache::bytes() const {
+    return prefixes.size() * size_t(W) * D * 3 * sizeof(float);
+}
+
+void FbmFieldCache::trim(int keepOctaves) {
+    while (!prefixes.empty() && bytes() > budget) {
+        // выбрасываем самую далёкую от keepOctaves сумму
+        auto far = prefixes.begin();
+        for (auto i = prefixes.begin(); i != prefixes.end(); ++i)
+            if (std::abs(i->first.first - keepOctaves) > std::abs(far->first.first - keepOctaves)) far = i;
+        prefixes.erase(far);
+    }
+}
+
+// Цена клеточного шума в октавах fBm на точку (3x3 клетки) — для выбора,
+// что держать в GraphFieldCache
+static const int GRAPH_CELLULAR_COST = 4;
+
+bool GraphFieldCache::generate(Heightfield& hf, const NoiseGraph& graph, ThreadPool& pool,
+                               const std::atomic<bool>* cancel, GenerationStats* stats) {
+    int W_ = hf.width(), D_ = hf.depth();
+    size_t count = size_t(W_) * D_;
+    if (count == 0) {  // пустая сетка: считать и кэшировать нечего
+        if (stats) *stats = GenerationStats{};
+        return true;
+    }
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+    if (W_ != W || D_ != D || hf.spacing() != step || hf.originX() != orgX || hf.originZ() != orgZ) {
+        buffers.clear();
+        W = W_; D = D_;
+        step = hf.spacing(); orgX = hf.originX(); orgZ = hf.originZ();
+    }
+
+    // обход от выхода: готовые узлы подгружаются, остальные считаются вместе
+    // со своими входами; координаты и константы берутся в программе даром
+    std::vector<uint64_t> sig = graph.signatures();
+    // state: 1 — считать, 2 — из кэша, 3 — лежит под подгруженным (только
+    // для счёта октав в статистике)
+    std::vector<char> state(sig.size(), 0);
+    std::vector<std::pair<NoiseGraph::Node, bool>> stack{ { graph.output(), false } };
+    std::vector<NoiseGraph::Node> loads, stores;
+    int octavesAll = 0, octavesNew = 0;
+    while (!stack.empty()) {
+        auto [i, under] = stack.back();
+        stack.pop_back();
+        NoiseOp op = graph.op(i);
+        if (op == NoiseOp::X || op == NoiseOp::Z || op == NoiseOp::Const) continue;
+        if (state[i] == 1 || state[i] == 2 || (under && state[i] == 3)) continue;
+        int octaves = op == NoiseOp::Fractal ? fbmOctavesPerSample(graph.fractalParams(i)) : 0;
+        if (state[i] == 0) octavesAll += octaves;
+        if (under) state[i] = 3;
+        else if (buffers.count(sig[i])) {
+            state[i] = 2;
+            loads.push_back(i);
+        }
+        else {
+            state[i] = 1;
+            octavesNew += octaves;
+        }
+        for (int k = 0; k < 3; ++k)
+            if (graph.input(i, k) >= 0) stack.push_back({ graph.input(i, k), state[i] != 1 });
+    }
+    // Что сохранять — решается до выделения буферов: только дорогие узлы
+    // (фракталы, клеточный шум) и выход, дорогие первыми, и не больше, чем
+    // влезает в бюджет рядом с подгружаемыми. Дешёвые узлы над ними
+    // пересчитываются из сохранённых входов почти даром.
+    auto rank = [&](NoiseGraph::Node i) {
+        if (i == graph.output()) return INT_MAX;
+        NoiseOp op = graph.op(i);
+        if (op == NoiseOp::Fractal) return fbmOctavesPerSample(graph.fractalParams(i));
+        return op == NoiseOp::Cellular ? GRAPH_CELLULAR_COST : 0;
+    };
+    auto byRank = [&](NoiseGraph::Node a, NoiseGraph::Node b) { return rank(a) > rank(b); };
+    std::vector<NoiseGraph::Node> candidates;
+    for (NoiseGraph::Node i = 0; i < graph.size(); ++i)
+        if (state[i] == 1 && rank(i) > 0) candidates.push_back(i);
+    std::stable_sort(candidates.begin(), candidates.end(), byRank);
+
+    size_t perBuffer = count * sizeof(float);
+    size_t slots = budget / perBuffer;
+    std::vector<uint64_t> pinned;  // подгружаемые: нужны до конца прохода
+    for (NoiseGraph::Node i : loads)
+        if (std::find(pinned.begin(), pinned.end(), sig[i]) == pinned.end()) pinned.push_back(sig[i]);
+    slots = slots > pinned.size() ? slots - pinned.size() : 0;
+
+    // одинаковые подграфы пишут один буфер
+    std::vector<std::vector<float>> fresh;
+    std::vector<uint64_t> freshSig;
+    for (NoiseGraph::Node i : candidates)
+        if (freshSig.size() < slots && std::find(freshSig.begin(), freshSig.end(), sig[i]) == freshSig.end()) {
+            stores.push_back(i);
+            freshSig.push_back(sig[i]);
+        }
+    // место под новые — заранее, давно не использованными из неподгружаемых
+    while (buffers.size() + freshSig.size() > pinned.size() + slots) {
+        auto old = buffers.end();
+        for (auto i = buffers.begin(); i != buffers.end(); ++i)
+            if (std::find(pinned.begin(), pinned.end(), i->first) == pinned.end() &&
+                (old == buffers.end() || i->second.used < old->second.used)) old = i;
+        if (old == buffers.end()) break;
+        buffers.erase(old);
+    }
+
+    if (stats) {
+        *stats = GenerationStats{};
+        stats->octavesRequested = octavesAll;
+        stats->octavesEvaluated = octavesNew;
+        stats->noiseEvaluations = count * size_t(octavesNew);
+    }
+
+    if (state[graph.output()] == 2) {
+        // выход целиком из кэша
+        Buffer& b = buffers[sig[graph.output()]];
+        b.used = ++tick;
+        std::copy(b.data.begin(), b.data.end(), hf.data());
+    }
+    else {
+        NoiseProgram prog = graph.compile(loads, stores);
+        std::vector<const float*> loadBase;
+        for (NoiseGraph::Node i : loads) loadBase.push_back(buffers[sig[i]].data.data());
+        fresh.resize(stores.size());
+        for (auto& f : fresh) f.resize(count);
+
+        std::vector<float> xs(W);
+        for (int x = 0; x < W; ++x) xs[x] = hf.worldX(x);
+        pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+            if (cancelled()) return;
+            std::vector<float> zs(W);
+            std::vector<const float*> lp(loadBase.size());
+            std::vector<float*> sp(fresh.size());
+            for (int z = z0; z < z1; ++z) {
+                size_t r = size_t(z) * W;
+                std::fill(zs.begin(), zs.end(), hf.worldZ(z));
+                for (size_t k = 0; k < lp.size(); ++k) lp[k] = loadBase[k] + r;
+                for (size_t k = 0; k < sp.size(); ++k) sp[k] = fresh[k].data() + r;
+                prog.run(xs.data(), zs.data(), W, hf.row(z), lp.data(), sp.data());
+            }
+            });
+        if (cancelled()) return false;  // недописанные буферы в кэш не попадают
+
+        for (size_t k = 0; k < fresh.size(); ++k) buffers[freshSig[k]].data = std::move(fresh[k]);
+        // у использованных в этом проходе — разные tick по рангу: при
+        // вытеснении первыми уходят самые дешёвые из них
+        std::vector<NoiseGraph::Node> used(loads);
+        used.insert(used.end(), stores.begin(), stores.end());
+        std::stable_sort(used.begin(), used.end(), byRank);
+        for (auto i = used.rbegin(); i != used.rend(); ++i) buffers[sig[*i]].used = ++tick;
+        trim();
+    }
+    hf.dropGradients();
+    hf.updateBounds(pool);
+    return true;
+}
+
+void GraphFieldCache::setBudget(size_t bytes) {
+    budget = bytes;
+    trim();
+}
+
+void GraphFieldCache::trim() {
+    while (!buffers.empty() && bytes() > budget) {
+        auto old = buffers.begin();
+        for (auto i = buffers.begin(); i != buffers.end(); ++i)
+            if (i->second.used < old->second.used) old = i;
+        buffers.erase(old);
+    }
+}
\ No newline at end of file
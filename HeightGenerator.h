@@ -0,0 +1,154 @@
+#pragma once
+#include "Noise.h"
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Heightfield;
+class ThreadPool;
+class NoiseGraph;
+struct NoiseProgram;
+struct SpectralParams;
+struct DiamondSquareParams;
+
+// Генерация высот без GL-контекста: можно звать из тестов и бенчмарков.
+// Размер, шаг и origin берутся из hf; min/max обновляются.
+
+// Что сделала последняя генерация (показывается в ImGui)
+struct GenerationStats {
+    int    octavesRequested = 0;
+    int    octavesSkipped   = 0;  // выше частоты Найквиста (fbmClampToSpacing)
+    int    octavesEvaluated = 0;  // посчитано заново (без взятых из кэша)
+    size_t noiseEvaluations = 0;  // точка x октава
+    double milliseconds     = 0.0;
+};
+
+// h = (fbm * 0.5 + 0.5)^2 * amplitude. При withGradients заполняет и
+// hf.gradX/gradZ аналитическими производными за тот же проход.
+// cancel проверяется перед каждой полосой рядов; если он поднят, генерация
+// бросается (hf остаётся недописанной) и функция возвращает false.
+bool generateFbmHeights(Heightfield& hf, const FbmParams& fbm, float amplitude, ThreadPool& pool,
+                        bool withGradients = true, const std::atomic<bool>* cancel = nullptr,
+                        GenerationStats* stats = nullptr);
+
+// Допуск многоуровневого режима по умолчанию (единицы нормированного fBm)
+constexpr float FBM_MULTIRES_TOLERANCE = 1e-3f;
+
+// Многоуровневый режим: октава считается на сетке в 2^L раз реже и
+// восстанавливается бикубикой (Catmull-Rom, SIMD). L — наибольший, при котором
+// оценка погрешности интерполяции октавы не больше tolerance / octaves.
+// Октавы с L = 0 (высокие) считаются по узлам тем же ядром, что и в
+// generateFbmHeights; если таких все, результат совпадает побитово.
+// Градиенты не заполняются (hf.dropGradients()) — нормали берутся разностями
+// по сетке. Для форм, кроме FractalType::Fbm, и с warping — обычный
+// generateFbmHeights (тоже без градиентов).
+bool generateFbmHeightsMultiRes(Heightfield& hf, const FbmParams& fbm, float amplitude,
+                                ThreadPool& pool, float tolerance = FBM_MULTIRES_TOLERANCE,
+                                const std::atomic<bool>* cancel = nullptr,
+                                GenerationStats* stats = nullptr);
+
+// Высоты по скомпилированному графу (NoiseGraph::compile): значение графа —
+// сразу высота, форма и амплитуда задаются узлами. Параллельно по полосам
+// рядов, ряд — одним вызовом интерпретатора. Градиенты не заполняются.
+bool generateGraphHeights(Heightfield& hf, const NoiseProgram& prog, ThreadPool& pool,
+                          const std::atomic<bool>* cancel = nullptr,
+                          GenerationStats* stats = nullptr);
+
+// Спектральный синтез (spectralField): поле за один проход обратного БПФ,
+// затем та же форма (n*0.5+0.5)^2 * amplitude. Частота и октавы не нужны —
+// их роль играют beta и полоса; поле тайлится с периодом сетки.
+// Градиенты не заполняются.
+bool generateSpectralHeights(Heightfield& hf, const SpectralParams& sp, float amplitude,
+                             ThreadPool& pool, const std::atomic<bool>* cancel = nullptr,
+                             GenerationStats* stats = nullptr);
+
+// Diamond-square (diamondSquareField) и та же форма. Быстрее fBm в разы —
+// для превью и фоновой заливки. Градиенты не заполняются.
+bool generateDiamondSquareHeights(Heightfield& hf, const DiamondSquareParams& dp, float amplitude,
+                                  ThreadPool& pool, const std::atomic<bool>* cancel = nullptr,
+                                  GenerationStats* stats = nullptr);
+
+// Кэш fBm-поля для инкрементальной перегенерации. Хранит сырые суммы октав
+// [0, k) (значение и производные) для нескольких k; generate() продолжает
+// ближайшую сохранённую сумму снизу, а не считает все октавы заново:
+//   амплитуда     — шум не считается вовсе, только (n*0.5+0.5)^2*A;
+//   октав больше  — считаются только новые октавы;
+//   октав меньше  — берётся сохранённая сумма (вычитание слоёв дало бы
+//                   погрешность округления, префикс — нет).
+// Результат побитово совпадает с generateFbmHeights(..., withGradients=true).
+// Суммы хранятся с весом последней октавы (fbmClampToSpacing), так что
+// затухающая октава не смешивается с полной.
+// Смена базиса, формы, сида, частоты, смещения или геометрии сетки сбрасывает кэш.
+// Неаддитивные поля (ridged, hybrid, warping; см. fbmAdditive) не кэшируются —
+// считаются целиком одним проходом. Объём
+// ограничен budgetBytes: лишние суммы выбрасываются, дальние от текущей
+// октавы — первыми. Не потокобезопасен.
+class FbmFieldCache {
+public:
+    explicit FbmFieldCache(size_t budgetBytes = size_t(256) << 20) : budget(budgetBytes) {}
+
+    bool generate(Heightfield& hf, const FbmParams& fbm, float amplitude, ThreadPool& pool,
+                  const std::atomic<bool>* cancel = nullptr, GenerationStats* stats = nullptr);
+
+    void   clear() { prefixes.clear(); }
+    void   setBudget(size_t bytes);
+    size_t bytes() const;
+
+private:
+    struct Sums { std::vector<float> n, dx, dz; };
+
+    // то, от чего зависят суммы
+    int   W = 0, D = 0;
+    float step = 0.0f, orgX = 0.0f, orgZ = 0.0f;
+    float frequency = 0.0f, offset = 0.0f;
+    NoiseBasis basis = NoiseBasis::Perlin;
+    FractalType fractal = FractalType::Fbm;
+    uint32_t   seed = 0;
+
+    // (число октав, вес последней) -> сырые суммы
+    std::map<std::pair<int, float>, Sums> prefixes;
+    size_t budget;
+
+    void trim(int keepOctaves);
+};
+
+// Кэш графа для инкрементальной перегенерации: буфер значений (вся сетка) на
+// каждый посчитанный узел, ключ — хеш подграфа (NoiseGraph::signatures()).
+// Правка узла меняет хеш только его и узлов ниже по графу, поэтому generate()
+// подгружает самые нижние неизменённые узлы и пересчитывает лишь то, что под
+// правкой: время растёт с размером изменённого подграфа, а не всего графа.
+// Результат тот же, что у generateGraphHeights(hf, graph.compile(), ...).
+// Смена геометрии сетки сбрасывает кэш. Объём ограничен budgetBytes и в
+// пике: буферы заводятся только у дорогих узлов (фракталы, клеточный шум) и
+// у выхода, дорогие первыми, и только сколько влезет; место освобождается
+// заранее, давно не использованные — первыми, среди одного прохода —
+// дешёвые. Не потокобезопасен.
+class GraphFieldCache {
+public:
+    explicit GraphFieldCache(size_t budgetBytes = size_t(256) << 20) : budget(budgetBytes) {}
+
+    bool generate(Heightfield& hf, const NoiseGraph& graph, ThreadPool& pool,
+                  const std::atomic<bool>* cancel = nullptr, GenerationStats* stats = nullptr);
+
+    void   clear() { buffers.clear(); }
+    void   setBudget(size_t bytes);
+    size_t bytes() const { return buffers.size() * size_t(W) * D * sizeof(float); }
+
+private:
+    struct Buffer {
+        std::vector<float> data;
+        uint64_t used = 0;  // tick последнего использования
+    };
+
+    int   W = 0, D = 0;
+    float step = 0.0f, orgX = 0.0f, orgZ = 0.0f;
+
+    std::unordered_map<uint64_t, Buffer> buffers;
+    uint64_t tick = 0;
+    size_t   budget;
+
+    void trim();
+};
@@ -0,0 +1,87 @@
+#include "Heightfield.h"
+#include "ThreadPool.h"
+#include "Simd.h"
+#include <algorithm>
+#include <limits>
+
+Heightfield::Heightfield(int width, int depth, float spacing, float originX, float originZ) {
+    resize(width, depth, spacing, originX, originZ);
+}
+
+void Heightfield::resize(int width, int depth, float spacing, float originX, float originZ) {
+    W = width;
+    D = depth;
+    step = spacing;
+    orgX = originX;
+    orgZ = originZ;
+    heights.resize(size_t(W) * D);
+    if (hasGradients()) allocGradients();
+}
+
+void Heightfield::updateBounds(ThreadPool& pool) {
+    if (heights.empty()) { minH = maxH = 0.0f; return; }
+
+    // мин/макс по рядам, потом свёртка — порядок не влияет на результат
+    std::vector<float> rowMin(D), rowMax(D);
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) {
+            const float* r = row(z);
+            auto mm = std::minmax_element(r, r + W);
+            rowMin[z] = *mm.first;
+            rowMax[z] = *mm.second;
+        }
+        });
+    minH = *std::min_element(rowMin.begin(), rowMin.end());
+    maxH = *std::max_element(rowMax.begin(), rowMax.end());
+}
+
+void Heightfield::computeGradients(ThreadPool& pool) {
+    allocGradients();
+    computeGradients(pool, 0, D);
+}
+
+void Heightfield::computeGradients(ThreadPool& pool, int zBegin, int zEnd) {
+    if (heights.empty()) return;
+    if (!hasGradients()) allocGradients();
+    zBegin = std::max(zBegin, 0);
+    zEnd = std::min(zEnd, D);
+
+    const SimdKernels& k = simdKernels();
+    float inv2s = 0.5f / step;
+    pool.parallelFor(zBegin, zEnd, rowBand(W), [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) {
+            int zp = z > 0 ? z - 1 : z;
+            int zn = z < D - 1 ? z + 1 : z;
+            // на краях шаг по z вдвое меньше
+            float scaleZ = (zn - zp) == 2 ? inv2s : (zn != zp ? 2.0f * inv2s : 0.0f);
+            k.gradientRow(row(zp), row(z), row(zn), W, inv2s, scaleZ, gradXRow(z), gradZRow(z));
+        }
+        });
+}
+
+void Heightfield::computeGradients(ThreadPool& pool, int xBegin, int xEnd, int zBegin, int zEnd) {
+    xBegin = std::max(xBegin, 0);
+    xEnd = std::min(xEnd, W);
+    if (xBegin == 0 && xEnd == W) { computeGradients(pool, zBegin, zEnd); return; }
+    if (heights.empty() || xBegin >= xEnd) return;
+    if (!hasGradients()) allocGradients();
+    zBegin = std::max(zBegin, 0);
+    zEnd = std::min(zEnd, D);
+
+    // отрезок с запасом в узел: у его краёв центральной разности нужен сосед,
+    // а односторонняя верна только на краю сетки — её и оставляем
+    int a = std::max(xBegin - 1, 0), n = std::min(xEnd + 1, W) - a;
+    const SimdKernels& k = simdKernels();
+    float inv2s = 0.5f / step;
+    pool.parallelFor(zBegin, zEnd, rowBand(n), [&](int z0, int z1) {
+        std::vector<float> gx(n), gz(n);
+        for (int z = z0; z < z1; ++z) {
+            int zp = z > 0 ? z - 1 : z;
+            int zn = z < D - 1 ? z + 1 : z;
+            float scaleZ = (zn - zp) == 2 ? inv2s : (zn != zp ? 2.0f * inv2s : 0.0f);
+            k.gradientRow(row(zp) + a, row(z) + a, row(zn) + a, n, inv2s, scaleZ, gx.data(), gz.data());
+            std::copy(gx.begin() + (xBegin - a), gx.begin() + (xEnd - a), gradXRow(z) + xBegin);
+            std::copy(gz.begin() + (xBegin - a), gz.begin() + (xEnd - a), gradZRow(z) + xBegin);
+        }
+        });
+}
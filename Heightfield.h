@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+// Сетка высот без GL: плотный массив float, ряд за рядом (z), шаг spacing
+// между соседними узлами, origin — мировые координаты узла (0, 0).
+class Heightfield {
+public:
+    Heightfield() = default;
+    Heightfield(int width, int depth, float spacing, float originX = 0.0f, float originZ = 0.0f);
+
+    void resize(int width, int depth, float spacing, float originX = 0.0f, float originZ = 0.0f);
+
+    int   width()   const { return W; }
+    int   depth()   const { return D; }
+    float spacing() const { return step; }
+    float originX() const { return orgX; }
+    float originZ() const { return orgZ; }
+    float worldX(int x) const { return orgX + x * step; }
+    float worldZ(int z) const { return orgZ + z * step; }
+    size_t size() const { return heights.size(); }
+
+    float*       data()       { return heights.data(); }
+    const float* data() const { return heights.data(); }
+    float*       row(int z)       { return &heights[size_t(z) * W]; }
+    const float* row(int z) const { return &heights[size_t(z) * W]; }
+    float& at(int x, int z)       { return heights[size_t(z) * W + x]; }
+    float  at(int x, int z) const { return heights[size_t(z) * W + x]; }
+
+    // Производные dh/dx, dh/dz в мировых единицах, если генератор их выдал
+    // (аналитический шум). Пусто — нормали надо считать по самой сетке.
+    bool hasGradients() const { return !dhdx.empty(); }
+    void allocGradients() { dhdx.resize(heights.size()); dhdz.resize(heights.size()); }
+    void dropGradients()  { dhdx.clear(); dhdz.clear(); }
+    float*       gradXRow(int z)       { return &dhdx[size_t(z) * W]; }
+    const float* gradXRow(int z) const { return &dhdx[size_t(z) * W]; }
+    float*       gradZRow(int z)       { return &dhdz[size_t(z) * W]; }
+    const float* gradZRow(int z) const { return &dhdz[size_t(z) * W]; }
+
+    // Градиенты по самой сетке (импорт, эрозия и т.п.): центральные разности,
+    // односторонние на краях; параллельно по рядам, SIMD внутри ряда
+    void computeGradients(ThreadPool& pool);
+    // То же только для рядов [z0, z1) (после правки рядов z0+1 .. z1-2)
+    void computeGradients(ThreadPool& pool, int z0, int z1);
+    // И только для узлов [x0, x1) этих рядов; остальные градиенты
+    // (например, аналитические) не трогаются
+    void computeGradients(ThreadPool& pool, int x0, int x1, int z0, int z1);
+
+    // Мин/макс высоты; валидны после updateBounds()
+    float minHeight() const { return minH; }
+    float maxHeight() const { return maxH; }
+    void  updateBounds(ThreadPool& pool);
+
+private:
+    int   W = 0, D = 0;
+    float step = 1.0f;
+    float orgX = 0.0f, orgZ = 0.0f;
+    float minH = 0.0f, maxH = 0.0f;
+    std::vector<float> heights;
+    std::vector<float> dhdx, dhdz;
+};
+
+// Полоса рядов для parallelFor: ~16K сэмплов, зависит только от ширины,
+// поэтому разбиение (и результат) не зависит от числа потоков
+inline int rowBand(int width) { return width > 0 && width < 16384 ? 16384 / width : 1; }
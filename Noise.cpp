@@ -0,0 +1,101 @@
+#include "Noise.h"
+#include "Simd.h"
+#include <glm/gtc/noise.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Таблицы на сид: ГПСЧ splitmix64 — только целочисленная арифметика,
+// результат одинаков на любой платформе и при любом числе потоков
+static uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static void buildNoiseTables(uint32_t seed, NoiseTables& t) {
+    // 16 направлений через 22.5 градуса — константы, а не cos/sin из libm
+    static const float dirs[16][2] = {
+        {  1.0f,         0.0f        }, {  0.92387953f,  0.38268343f },
+        {  0.70710678f,  0.70710678f }, {  0.38268343f,  0.92387953f },
+        {  0.0f,         1.0f        }, { -0.38268343f,  0.92387953f },
+        { -0.70710678f,  0.70710678f }, { -0.92387953f,  0.38268343f },
+        { -1.0f,         0.0f        }, { -0.92387953f, -0.38268343f },
+        { -0.70710678f, -0.70710678f }, { -0.38268343f, -0.92387953f },
+        {  0.0f,        -1.0f        }, {  0.38268343f, -0.92387953f },
+        {  0.70710678f, -0.70710678f }, {  0.92387953f, -0.38268343f },
+    };
+    uint64_t state = seed;
+    int perm[256];
+    for (int i = 0; i < 256; ++i) perm[i] = i;
+    for (int i = 255; i > 0; --i)
+        std::swap(perm[i], perm[splitmix64(state) % uint64_t(i + 1)]);
+    for (int i = 0; i < 512; ++i) t.perm[i] = float(perm[i & 255]);
+    for (int i = 0; i < 256; ++i) {
+        const float* d = dirs[splitmix64(state) & 15];
+        t.gradX[i] = d[0];
+        t.gradY[i] = d[1];
+    }
+}
+
+const NoiseTables& noiseTables(uint32_t seed) {
+    static std::mutex mtx;
+    static std::map<uint32_t, std::unique_ptr<NoiseTables>> cache;
+    std::lock_guard<std::mutex> lock(mtx);
+    std::unique_ptr<NoiseTables>& t = cache[seed];
+    if (!t) {
+        t.reset(new NoiseTables);
+        buildNoiseTables(seed, *t);
+    }
+    return *t;
+}
+
+FbmParams fbmWithTables(const FbmParams& p) {
+    FbmParams q = p;
+    if (q.basis != NoiseBasis::GlmPerlin && !q.tables) q.tables = &noiseTables(q.seed);
+    return q;
+}
+
+void fbmBatch(const FbmParams& p, const float* x, const float* z, int count, float* out,
+              float* outDx, float* outDz) {
+    simdKernels().fbm[int(p.basis)](fbmWithTables(p), x, z, count, out, outDx, outDz);
+}
+
+void fbmAccumulate(const FbmParams& p, const float* x, const float* z, int count, float* acc,
+                   float* accDx, float* accDz) {
+    simdKernels().fbmAccum[int(p.basis)](fbmWithTables(p), x, z, count, acc, accDx, accDz);
+}
+
+void worleyBatch(const WorleyParams& p, const float* x, const float* z, int count, float* out) {
+    simdKernels().worley(p, x, z, count, out);
+}
+
+FbmParams fbmClampToSpacing(const FbmParams& p, float spacing, int* skipped) {
+    FbmParams c = p;
+    c.normOctaves = p.normOctaves > 0 ? p.normOctaves : p.octaves;
+    float freq = p.frequency;
+    for (int o = 0; o < p.octaves; ++o, freq *= 2) {
+        float r = freq * spacing;
+        if (o == 0 || r <= 0.25f) continue;
+        if (r >= 0.5f) { c.octaves = o; break; }
+        c.octaves = o + 1;
+        c.lastWeight = std::log2(0.5f / r);
+        break;
+    }
+    if (skipped) *skipped = p.octaves - c.octaves;
+    return c;
+}
+
+float fbmReference(const FbmParams& p, float x, float z) {
+    float n = 0, freq = p.frequency, amp = 1;
+    for (int o = 0; o < p.octaves; ++o) {
+        float a = o == p.octaves - 1 ? amp * p.lastWeight : amp;
+        n += glm::perlin(glm::vec2(x * freq + p.offset, z * freq + p.offset)) * a;
+        freq *= 2;
+        amp *= 0.5f;
+    }
+    return n / fbmNormalization(p);
+}
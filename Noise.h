@@ -0,0 +1,148 @@
+#pragma once
+#include <cstdint>
+
+// Батч-fBm поверх градиентного шума (см. NoiseBasis). Базис
+// NoiseBasis::GlmPerlin — тот же алгоритм, что glm::perlin: векторные пути
+// (SSE4.1 x4, AVX2 x8) считают те же формулы в том же порядке и без FMA
+// побитово совпадают с fbmReference().
+// Если компилятор сожмёт a*b+c в FMA (/fp:fast, -mfma), расхождение растёт
+// с |offset|: до ~1.5e-4 при 1000.
+// Гарантия: |fbm - fbmReference| <= NOISE_FBM_TOLERANCE.
+constexpr float NOISE_FBM_TOLERANCE = 2e-4f;
+
+// Базисный шум fBm
+enum class NoiseBasis {
+    Perlin,     // Перлин с сидом: таблицы перестановки/градиентов на сид (по умолчанию)
+    GlmPerlin,  // glm::perlin без сида, разнообразие — только через offset
+    Simplex,    // симплекс (OpenSimplex2-подобный) с сидом: 3 угла вместо 4
+    Count
+};
+
+// Форма фрактала поверх базиса. Все — в ~[-1, 1], на тех же SIMD-ядрах
+enum class FractalType {
+    Fbm,     // сумма октав
+    Ridged,  // ridged multifractal: острые гребни, детали только на них
+    Billow,  // сумма 2|noise| - 1: округлые холмы
+    Hybrid,  // hybrid multifractal: гладкие низины, детальные вершины
+    Count
+};
+
+// Таблицы шума для одного сида. Значения хранятся во float, чтобы ядра
+// индексировали их прямо из float-регистров (gather).
+struct NoiseTables {
+    float perm[512];              // перестановка 0..255, повторённая дважды
+    float gradX[256], gradY[256]; // единичный градиент по хешу угла решётки
+};
+
+// Таблицы сида: строятся один раз (целочисленный ГПСЧ, градиенты из
+// фиксированного набора направлений — без libm), дальше берутся из кэша.
+// Ссылка действительна до конца программы; потокобезопасно.
+const NoiseTables& noiseTables(uint32_t seed);
+
+struct FbmParams {
+    float frequency;
+    float offset;   // прибавляется к обеим координатам после умножения на частоту
+    int   octaves;  // частота x2, амплитуда x0.5 на каждую октаву
+    int   firstOctave = 0;  // fbmAccumulate: с какой октавы продолжать сумму
+    float lastWeight  = 1.0f; // множитель амплитуды октавы octaves-1 (плавное отсечение)
+    int   normOctaves = 0;    // нормировка как у стольких октав; 0 — как у octaves
+    NoiseBasis basis  = NoiseBasis::Perlin;
+    FractalType fractal = FractalType::Fbm;
+    // domain warping: точка сдвигается на warpStrength * (fbm, fbm') частоты
+    // warpFrequency до счёта основных октав; 0 — без сдвига
+    float warpStrength  = 0.0f;
+    float warpFrequency = 0.02f;
+    uint32_t   seed   = 0;        // для базисов с таблицами (Perlin, Simplex)
+    const NoiseTables* tables = nullptr;  // заполняют fbmBatch/fbmAccumulate по seed
+};
+
+// Октавы складываются независимо — работают fbmAccumulate, кэш префиксов.
+// Warping сдвигает все октавы сразу, его считают одним проходом.
+inline bool fbmAdditive(const FbmParams& p) {
+    return (p.fractal == FractalType::Fbm || p.fractal == FractalType::Billow) &&
+           p.warpStrength == 0.0f;
+}
+
+// Октав в каждой из двух компонент сдвига: половина от основных (по
+// запрошенному числу, а не отсечённому, чтобы поле не зависело от шага
+// сетки), так что warping добавляет не больше одной цены fBm
+inline int fbmWarpOctaves(const FbmParams& p) {
+    int k = (p.normOctaves > 0 ? p.normOctaves : p.octaves) / 2;
+    return k > 0 ? k : 1;
+}
+
+// Октав базисного шума на точку, включая сдвиг warping
+inline int fbmOctavesPerSample(const FbmParams& p) {
+    return p.octaves + (p.warpStrength != 0.0f ? 2 * fbmWarpOctaves(p) : 0);
+}
+
+// Клеточный шум (Worley): одна точка-признак на клетку со стороной
+// 1 / frequency, её место в клетке — целочисленный хеш (клетка, seed),
+// сдвинутый от центра на jitter. Ищутся два ближайших признака в 3x3
+// клетках вокруг точки.
+enum class WorleyMode {
+    F1,         // до ближайшего: чаши/кратеры с центром в признаке
+    F2,         // до второго
+    F2MinusF1,  // 0 на границах клеток: гребни между клетками, границы биомов
+};
+
+struct WorleyParams {
+    float frequency;
+    float jitter = 1.0f;        // 0 — признаки в центрах клеток (регулярная сетка)
+    WorleyMode mode = WorleyMode::F1;
+    uint32_t   seed = 0;
+};
+
+// Сумма амплитуд первых octaves октав (нормировка fBm), тем же порядком
+// сложения, что и в ядрах
+inline float fbmAmplitudeSum(int octaves) {
+    float amp = 1.0f, maxA = 0.0f;
+    for (int o = 0; o < octaves; ++o) {
+        maxA += amp;
+        amp *= 0.5f;
+    }
+    return maxA > 0.0f ? maxA : 1.0f;
+}
+
+// Делитель нормировки fBm для p (с учётом normOctaves)
+inline float fbmNormalization(const FbmParams& p) {
+    return fbmAmplitudeSum(p.normOctaves > 0 ? p.normOctaves : p.octaves);
+}
+
+// Отсечение октав по Найквисту для сетки с шагом spacing. Октава с частотой f
+// даёт r = f * spacing периодов решётки на шаг: при r >= 0.5 она выше частоты
+// Найквиста и даёт только алиасинг — пропускается; при 0.25 < r < 0.5
+// затухает (вес log2(0.5 / r)). Нормировка остаётся как у всех p.octaves,
+// чтобы соседние тайлы/LOD с разным шагом совпадали по низким частотам.
+// Октава 0 остаётся всегда. skipped — сколько октав отброшено целиком.
+FbmParams fbmClampToSpacing(const FbmParams& p, float spacing, int* skipped = nullptr);
+
+// Копия p с таблицами сида (если базис их требует). fbmBatch/fbmAccumulate
+// делают это сами, но берут кэш под мьютексом — генераторам выгоднее
+// заполнить tables один раз перед циклом по рядам.
+FbmParams fbmWithTables(const FbmParams& p);
+
+// out[i] = нормированный фрактал p.fractal в ~[-1, 1] для точек (x[i], z[i]).
+// Если заданы outDx и outDz, туда пишутся аналитические d(out)/dx, d(out)/dz
+// за тот же проход; out при этом побитово тот же, что и без них.
+// Реализация выбирается по CPU (см. Simd.h).
+void fbmBatch(const FbmParams& p, const float* x, const float* z, int count, float* out,
+              float* outDx = nullptr, float* outDz = nullptr);
+
+// Инкрементальный вариант: acc[i] += сырые (ненормированные) октавы
+// [p.firstOctave, p.octaves); accDx/accDz — так же для производных.
+// Только для fbmAdditive(p).
+// fbmBatch == (fbmAccumulate с нуля) / fbmAmplitudeSum(octaves) побитово,
+// и продолжение с сохранённой суммы октав [0, k) даёт тот же результат.
+void fbmAccumulate(const FbmParams& p, const float* x, const float* z, int count, float* acc,
+                   float* accDx = nullptr, float* accDz = nullptr);
+
+// out[i] = расстояние по WorleyParams::mode в долях клетки (F1 ~ [0, 1.1]).
+// Точки батча, идущие подряд по ряду, делят признаки соседних клеток: признаки
+// окна клеток считаются раз на вектор точек, расстояния — SIMD. Результат не
+// зависит от уровня SIMD и разбиения на батчи.
+void worleyBatch(const WorleyParams& p, const float* x, const float* z, int count, float* out);
+
+// Эталон для NoiseBasis::GlmPerlin: скалярный цикл с glm::perlin,
+// как было в Terrain::generate (basis, seed, fractal и warp игнорируются)
+float fbmReference(const FbmParams& p, float x, float z);
@@ -0,0 +1,309 @@
+#include "NoiseGraph.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+
+NoiseGraph::NoiseGraph() {
+    nodes.push_back({ NoiseOp::X });
+    nodes.push_back({ NoiseOp::Z });
+}
+
+NoiseGraph::Node NoiseGraph::push(NodeDesc d) {
+    nodes.push_back(std::move(d));
+    return out = Node(nodes.size() - 1);
+}
+
+NoiseGraph::Node NoiseGraph::binary(NoiseOp op, Node a, Node b) {
+    NodeDesc d{ op };
+    d.a = a;
+    d.b = b;
+    return push(std::move(d));
+}
+
+NoiseGraph::Node NoiseGraph::constant(float v) {
+    NodeDesc d{ NoiseOp::Const };
+    d.k0 = v;
+    return push(std::move(d));
+}
+
+NoiseGraph::Node NoiseGraph::fractal(const FbmParams& p, Node x, Node z) {
+    NodeDesc d{ NoiseOp::Fractal };
+    d.a = x;
+    d.b = z;
+    d.fbm = p;
+    return push(std::move(d));
+}
+
+NoiseGraph::Node NoiseGraph::cellular(const WorleyParams& p, Node x, Node z) {
+    NodeDesc d{ NoiseOp::Cellular };
+    d.a = x;
+    d.b = z;
+    d.cell = p;
+    return push(std::move(d));
+}
+
+NoiseGraph::Node NoiseGraph::add(Node a, Node b) { return binary(NoiseOp::Add, a, b); }
+NoiseGraph::Node NoiseGraph::sub(Node a, Node b) { return binary(NoiseOp::Sub, a, b); }
+NoiseGraph::Node NoiseGraph::mul(Node a, Node b) { return binary(NoiseOp::Mul, a, b); }
+NoiseGraph::Node NoiseGraph::min(Node a, Node b) { return binary(NoiseOp::Min, a, b); }
+NoiseGraph::Node NoiseGraph::max(Node a, Node b) { return binary(NoiseOp::Max, a, b); }
+
+NoiseGraph::Node NoiseGraph::affine(Node a, float scale, float bias) {
+    NodeDesc d{ NoiseOp::Affine };
+    d.a = a;
+    d.k0 = scale;
+    d.k1 = bias;
+    return push(std::move(d));
+}
+
+NoiseGraph::Node NoiseGraph::clamp(Node a, float lo, float hi) {
+    NodeDesc d{ NoiseOp::Clamp };
+    d.a = a;
+    d.k0 = lo;
+    d.k1 = hi;
+    return push(std::move(d));
+}
+
+NoiseGraph::Node NoiseGraph::blend(Node a, Node b, Node t) {
+    NodeDesc d{ NoiseOp::Blend };
+    d.a = a;
+    d.b = b;
+    d.c = t;
+    return push(std::move(d));
+}
+
+NoiseGraph::Node NoiseGraph::curve(Node a, const std::vector<float>& xs, const std::vector<float>& ys) {
+    NodeDesc d{ NoiseOp::Curve };
+    d.a = a;
+    d.xs = xs;
+    d.ys = ys;
+    d.xs.resize(std::min(xs.size(), ys.size()));
+    d.ys.resize(d.xs.size());
+    if (d.xs.empty()) { d.xs = { 0.0f }; d.ys = { 0.0f }; }
+    return push(std::move(d));
+}
+
+NoiseGraph::Node NoiseGraph::terrace(Node a, int steps, float slope) {
+    NodeDesc d{ NoiseOp::Terrace };
+    d.a = a;
+    d.k0 = float(std::max(steps, 1));
+    d.k1 = std::min(std::max(slope, 1e-3f), 1.0f);
+    return push(std::move(d));
+}
+
+// Скалярные формулы — те же, что в GraphKernels.h (для свёртки констант)
+static float curveScalar(float a, const std::vector<float>& xs, const std::vector<float>& ys) {
+    float y = ys[0];
+    for (size_t i = 0; i + 1 < xs.size(); ++i) {
+        float t = xs[i + 1] > xs[i] ? (a - xs[i]) * (1.0f / (xs[i + 1] - xs[i])) : (a < xs[i] ? 0.0f : 1.0f);
+        y += std::min(std::max(t, 0.0f), 1.0f) * (ys[i + 1] - ys[i]);
+    }
+    return y;
+}
+
+static float terraceScalar(float a, float steps, float slope) {
+    float t = a * steps, f = std::floor(t);
+    float u = std::min(std::max((t - f - (1.0f - slope)) * (1.0f / slope), 0.0f), 1.0f);
+    return (f + u) * (1.0f / steps);
+}
+
+NoiseProgram NoiseGraph::compile() const {
+    return compile({}, {});
+}
+
+NoiseProgram NoiseGraph::compile(const std::vector<Node>& loads, const std::vector<Node>& stores) const {
+    // 0) узлы из внешних буферов становятся источниками
+    std::vector<NodeDesc> n = nodes;
+    for (size_t k = 0; k < loads.size(); ++k) {
+        n[loads[k]] = NodeDesc{ NoiseOp::Load };
+        n[loads[k]].slot = int(k);
+    }
+
+    // 1) упрощение: alias[i] — узел, которым заменяется i
+    std::vector<Node> alias(n.size());
+    auto isConst = [&](Node i) { return i >= 0 && n[i].op == NoiseOp::Const; };
+    auto toConst = [&](NodeDesc& d, float v) { d = NodeDesc{ NoiseOp::Const }; d.k0 = v; };
+    auto toAffine = [&](NodeDesc& d, Node a, float s, float b) {
+        d = NodeDesc{ NoiseOp::Affine };
+        d.a = a; d.k0 = s; d.k1 = b;
+    };
+    for (size_t i = 0; i < n.size(); ++i) {
+        alias[i] = Node(i);
+        NodeDesc& d = n[i];
+        if (d.a >= 0) d.a = alias[d.a];
+        if (d.b >= 0) d.b = alias[d.b];
+        if (d.c >= 0) d.c = alias[d.c];
+        if (d.op == NoiseOp::X || d.op == NoiseOp::Z || d.op == NoiseOp::Const ||
+            d.op == NoiseOp::Fractal || d.op == NoiseOp::Cellular || d.op == NoiseOp::Load)
+            continue;
+
+        bool ca = isConst(d.a), cb = d.b < 0 || isConst(d.b), cc = d.c < 0 || isConst(d.c);
+        if (ca && cb && cc) {
+            float a = n[d.a].k0, b = d.b >= 0 ? n[d.b].k0 : 0.0f, c = d.c >= 0 ? n[d.c].k0 : 0.0f;
+            float v = 0.0f;
+            switch (d.op) {
+            case NoiseOp::Add:     v = a + b; break;
+            case NoiseOp::Sub:     v = a - b; break;
+            case NoiseOp::Mul:     v = a * b; break;
+            case NoiseOp::Min:     v = std::min(a, b); break;
+            case NoiseOp::Max:     v = std::max(a, b); break;
+            case NoiseOp::Affine:  v = a * d.k0 + d.k1; break;
+            case NoiseOp::Clamp:   v = std::min(std::max(a, d.k0), d.k1); break;
+            case NoiseOp::Blend:   v = a + (b - a) * c; break;
+            case NoiseOp::Curve:   v = curveScalar(a, d.xs, d.ys); break;
+            case NoiseOp::Terrace: v = terraceScalar(a, d.k0, d.k1); break;
+            default: break;
+            }
+            toConst(d, v);
+            continue;
+        }
+        // операция с константой — Affine
+        if (d.op == NoiseOp::Add && (ca || isConst(d.b)))
+            toAffine(d, ca ? d.b : d.a, 1.0f, n[ca ? d.a : d.b].k0);
+        else if (d.op == NoiseOp::Sub && isConst(d.b))
+            toAffine(d, d.a, 1.0f, -n[d.b].k0);
+        else if (d.op == NoiseOp::Sub && ca)
+            toAffine(d, d.b, -1.0f, n[d.a].k0);
+        else if (d.op == NoiseOp::Mul && (ca || isConst(d.b)))
+            toAffine(d, ca ? d.b : d.a, n[ca ? d.a : d.b].k0, 0.0f);
+        // цепочки Affine не сливаются: другое округление, и значения узлов
+        // разошлись бы с сохранёнными в GraphFieldCache
+        if (d.op == NoiseOp::Affine && d.k0 == 1.0f && d.k1 == 0.0f) alias[i] = d.a;
+    }
+
+    // 2) живые узлы и последнее чтение каждого
+    const Node result = alias[out];
+    std::vector<char> live(n.size(), 0);
+    std::vector<int> lastUse(n.size(), -1);
+    live[result] = 1;
+    std::vector<std::vector<int>> storeAt(n.size());
+    for (size_t k = 0; k < stores.size(); ++k) {
+        Node s = alias[stores[k]];
+        storeAt[s].push_back(int(k));
+        live[s] = 1;
+    }
+    for (int i = int(n.size()) - 1; i >= 0; --i) {
+        if (!live[i] || alias[i] != i) continue;
+        for (Node in : { n[i].a, n[i].b, n[i].c })
+            if (in >= 0) {
+                live[in] = 1;
+                lastUse[in] = std::max(lastUse[in], i);
+            }
+    }
+    lastUse[result] = int(n.size());
+
+    // 3) инструкции по порядку узлов; регистр входа освобождается на его
+    //    последнем чтении и может сразу стать dst (все операции поэлементные)
+    NoiseProgram prog;
+    std::vector<int> reg(n.size(), -1), freeRegs;
+    reg[0] = 0;
+    reg[1] = 1;
+    auto emitStores = [&](Node i) {
+        for (int slot : storeAt[i]) {
+            NoiseInstr st{ NoiseOp::Store, -1 };
+            st.a = reg[i];
+            st.param = slot;
+            prog.code.push_back(st);
+        }
+    };
+    for (int r : { 0, 1 }) {
+        emitStores(r);
+        if (lastUse[r] < 0) freeRegs.push_back(r);
+    }
+    for (int i = 2; i < int(n.size()); ++i) {
+        if (!live[i] || alias[i] != i) continue;
+        const NodeDesc& d = n[i];
+        NoiseInstr in{ d.op, -1 };
+        in.a = d.a >= 0 ? reg[d.a] : -1;
+        in.b = d.b >= 0 ? reg[d.b] : -1;
+        in.c = d.c >= 0 ? reg[d.c] : -1;
+        in.k0 = d.k0;
+        in.k1 = d.k1;
+        if (d.op == NoiseOp::Fractal) {
+            in.param = int(prog.fractals.size());
+            prog.fractals.push_back(fbmWithTables(d.fbm));
+        }
+        if (d.op == NoiseOp::Cellular) {
+            in.param = int(prog.cellular.size());
+            prog.cellular.push_back(d.cell);
+        }
+        if (d.op == NoiseOp::Load) in.param = d.slot;
+        if (d.op == NoiseOp::Curve) {
+            in.param = int(prog.consts.size());
+            in.count = int(d.xs.size());
+            for (size_t k = 0; k < d.xs.size(); ++k) {
+                prog.consts.push_back(d.xs[k]);
+                prog.consts.push_back(d.ys[k]);
+            }
+        }
+        Node inputs[3] = { d.a, d.b, d.c };
+        for (int k = 0; k < 3; ++k) {
+            Node s = inputs[k];
+            bool dup = (k > 0 && s == inputs[0]) || (k > 1 && s == inputs[1]);
+            if (s >= 0 && !dup && lastUse[s] == i) freeRegs.push_back(reg[s]);
+        }
+        if (!freeRegs.empty()) {
+            in.dst = freeRegs.back();
+            freeRegs.pop_back();
+        }
+        else in.dst = prog.registers++;
+        reg[i] = in.dst;
+        prog.code.push_back(in);
+        emitStores(i);
+        if (lastUse[i] < 0) freeRegs.push_back(in.dst);   // только сохраняется
+    }
+    prog.output = reg[result];
+    return prog;
+}
+
+std::vector<uint64_t> NoiseGraph::signatures() const {
+    // FNV-1a по полям узла и хешам входов
+    auto mix = [](uint64_t& h, const void* p, size_t bytes) {
+        const unsigned char* c = static_cast<const unsigned char*>(p);
+        for (size_t i = 0; i < bytes; ++i) h = (h ^ c[i]) * 0x100000001B3ull;
+    };
+    std::vector<uint64_t> sig(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        const NodeDesc& d = nodes[i];
+        uint64_t h = 0xCBF29CE484222325ull;
+        mix(h, &d.op, sizeof(d.op));
+        mix(h, &d.k0, sizeof(float));
+        mix(h, &d.k1, sizeof(float));
+        for (Node in : { d.a, d.b, d.c }) {
+            uint64_t s = in >= 0 ? sig[in] : 0;
+            mix(h, &s, sizeof(s));
+        }
+        if (d.op == NoiseOp::Fractal) {
+            // tables — производное от seed
+            const FbmParams& p = d.fbm;
+            float f[] = { p.frequency, p.offset, p.lastWeight, p.warpStrength, p.warpFrequency };
+            int k[] = { p.octaves, p.firstOctave, p.normOctaves, int(p.basis), int(p.fractal), int(p.seed) };
+            mix(h, f, sizeof(f));
+            mix(h, k, sizeof(k));
+        }
+        if (d.op == NoiseOp::Cellular) {
+            const WorleyParams& p = d.cell;
+            float f[] = { p.frequency, p.jitter };
+            int k[] = { int(p.mode), int(p.seed) };
+            mix(h, f, sizeof(f));
+            mix(h, k, sizeof(k));
+        }
+        if (!d.xs.empty()) {
+            mix(h, d.xs.data(), d.xs.size() * sizeof(float));
+            mix(h, d.ys.data(), d.ys.size() * sizeof(float));
+        }
+        sig[i] = h;
+    }
+    return sig;
+}
+
+void NoiseProgram::run(const float* x, const float* z, int count, float* out,
+                       const float* const* loads, float* const* stores) const {
+    simdKernels().program(*this, x, z, count, out, loads, stores);
+}
+
+int NoiseProgram::octavesPerSample() const {
+    int total = 0;
+    for (const FbmParams& p : fractals) total += fbmOctavesPerSample(p);
+    return total;
+}
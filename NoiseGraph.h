@@ -0,0 +1,122 @@
+#pragma once
+#include "Noise.h"
+#include <cstdint>
+#include <vector>
+
+// Граф функции высоты: узлы — источники (координаты, константы, фракталы)
+// и поэлементные операции над ними. Граф не считает сам — compile()
+// превращает его в NoiseProgram: плоский список инструкций над регистрами.
+
+// Операции (и узлов графа, и инструкций программы)
+enum class NoiseOp : uint8_t {
+    X, Z,       // мировые координаты точки
+    Const,      // k0
+    Fractal,    // фрактал fractals[param] в точке (a, b)
+    Cellular,   // клеточный шум cellular[param] в точке (a, b)
+    Add, Sub, Mul, Min, Max,
+    Affine,     // a * k0 + k1
+    Clamp,      // clamp(a, k0, k1)
+    Blend,      // a + (b - a) * c
+    Curve,      // кусочно-линейная кривая: точки (x, y) — consts[param .. param + 2*count)
+    Terrace,    // k0 ступеней, k1 — доля ступени под склон (1 — без площадок)
+    Load,       // значение из внешнего буфера loads[param] (только в программе)
+    Store,      // a -> внешний буфер stores[param] (только в программе)
+};
+
+// Инструкция: dst = op(a, b, c) над регистрами блока точек
+struct NoiseInstr {
+    NoiseOp op;
+    int     dst;
+    int     a = -1, b = -1, c = -1;
+    int     param = 0, count = 0;
+    float   k0 = 0.0f, k1 = 0.0f;
+};
+
+// Скомпилированный граф. Регистры 0 и 1 в начале блока — x и z.
+// Интерпретатор (GraphKernels.h) идёт по блокам в NOISE_PROGRAM_BLOCK точек и
+// для каждой инструкции прогоняет SIMD-цикл по всему блоку: диспетчеризация —
+// раз на блок, а не на точку; фракталы считаются теми же ядрами, что fbmBatch.
+constexpr int NOISE_PROGRAM_BLOCK = 256;
+
+struct NoiseProgram {
+    std::vector<NoiseInstr> code;
+    std::vector<FbmParams>  fractals;   // с заполненными tables
+    std::vector<WorleyParams> cellular;
+    std::vector<float>      consts;
+    int registers = 2;
+    int output    = 0;                  // регистр результата
+
+    // out[i] = значение графа в (x[i], z[i]); потокобезопасно.
+    // loads/stores — буферы Load/Store, уже смещённые к точке x[0]
+    void run(const float* x, const float* z, int count, float* out,
+             const float* const* loads = nullptr, float* const* stores = nullptr) const;
+
+    // Октав фракталов на точку (для статистики)
+    int octavesPerSample() const;
+};
+
+class NoiseGraph {
+public:
+    using Node = int;
+
+    NoiseGraph();
+
+    Node x() const { return 0; }
+    Node z() const { return 1; }
+    Node constant(float v);
+    // Фрактал p в точке (x, z); по умолчанию — в самой точке
+    Node fractal(const FbmParams& p, Node x = 0, Node z = 1);
+    Node cellular(const WorleyParams& p, Node x = 0, Node z = 1);
+    Node add(Node a, Node b);
+    Node sub(Node a, Node b);
+    Node mul(Node a, Node b);
+    Node min(Node a, Node b);
+    Node max(Node a, Node b);
+    Node affine(Node a, float scale, float bias);
+    Node clamp(Node a, float lo, float hi);
+    Node blend(Node a, Node b, Node t);
+    // точки (xs[i], ys[i]) по возрастанию x; вне диапазона — крайние значения
+    Node curve(Node a, const std::vector<float>& xs, const std::vector<float>& ys);
+    Node terrace(Node a, int steps, float slope);
+
+    void setOutput(Node n) { out = n; }
+    Node output() const { return out; }
+    int  size() const { return int(nodes.size()); }
+
+    // Описание узла (для кэшей и статистики)
+    NoiseOp          op(Node n) const { return nodes[n].op; }
+    Node             input(Node n, int k) const { return k == 0 ? nodes[n].a : k == 1 ? nodes[n].b : nodes[n].c; }
+    const FbmParams& fractalParams(Node n) const { return nodes[n].fbm; }
+
+    // Свёртка констант, операции с константой -> Affine, удаление
+    // недостижимых узлов, распределение регистров по времени жизни значений
+    // (регистр освобождается после последнего чтения).
+    NoiseProgram compile() const;
+
+    // Для инкрементального счёта (GraphFieldCache): значения узлов loads[k]
+    // берутся из буфера loads[k] программы (их входы не считаются), значения
+    // узлов stores[k] дополнительно пишутся в буфер stores[k].
+    NoiseProgram compile(const std::vector<Node>& loads, const std::vector<Node>& stores) const;
+
+    // Хеш содержимого подграфа каждого узла: операция, параметры и хеши
+    // входов. Правка узла меняет хеш его и всех узлов ниже по графу, и только
+    // их; одинаковые подграфы дают одинаковый хеш.
+    std::vector<uint64_t> signatures() const;
+
+private:
+    struct NodeDesc {
+        NodeDesc(NoiseOp o = NoiseOp::Const) : op(o) {}
+        NoiseOp op;
+        Node    a = -1, b = -1, c = -1;
+        int     slot = -1;   // Load: номер буфера
+        float   k0 = 0.0f, k1 = 0.0f;
+        FbmParams fbm{ 0.0f, 0.0f, 0 };
+        WorleyParams cell{ 0.0f };
+        std::vector<float> xs, ys;
+    };
+    std::vector<NodeDesc> nodes;
+    Node out = 0;
+
+    Node push(NodeDesc d);
+    Node binary(NoiseOp op, Node a, Node b);
+};
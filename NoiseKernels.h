@@ -0,0 +1,608 @@
+#pragma once
+// Шаблонные ядра шума над типами из SimdTypes.h (F1 / F4 / F8).
+// Подключается только из Simd*.cpp.
+#include "SimdTypes.h"
+#include "Noise.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+template<typename V> inline V vconst(float s) { return V::set1(s); }
+
+// Нормировка simplex2 к ~[-1, 1]: с единичными градиентами максимум
+// суммы трёх углов ~1/99.2 (замер по 10^6 точек)
+constexpr float SIMPLEX_SCALE = 99.2f;
+
+// glm::detail::mod289 / permute / taylorInvSqrt / fade — один в один,
+// включая порядок операций, чтобы совпадать с glm::perlin
+template<typename V>
+inline V mod289(V x) {
+    return x - vfloor(x * vconst<V>(1.0f / 289.0f)) * vconst<V>(289.0f);
+}
+
+template<typename V>
+inline V permute(V x) {
+    return mod289((x * vconst<V>(34.0f) + vconst<V>(1.0f)) * x);
+}
+
+template<typename V>
+inline V fract(V x) { return x - vfloor(x); }
+
+template<typename V>
+inline V mix(V a, V b, V t) { return a * (vconst<V>(1.0f) - t) + b * t; }
+
+template<typename V>
+inline V fade(V t) {
+    return (t * t * t) * (t * (t * vconst<V>(6.0f) - vconst<V>(15.0f)) + vconst<V>(10.0f));
+}
+
+// Градиент угла решётки по хешу (gx, gy) — как в glm::perlin(vec2)
+template<typename V>
+inline void perlinGrad(V hash, V& gx, V& gy) {
+    gx = vconst<V>(2.0f) * fract(hash / vconst<V>(41.0f)) - vconst<V>(1.0f);
+    gy = vabs(gx) - vconst<V>(0.5f);
+    gx = gx - vfloor(gx + vconst<V>(0.5f));
+    V norm = vconst<V>(1.79284291400159f) - vconst<V>(0.85373472095314f) * (gx * gx + gy * gy);
+    gx = gx * norm;
+    gy = gy * norm;
+}
+
+// fade'(t) = 30 t^2 (t - 1)^2
+template<typename V>
+inline V fadeDeriv(V t) {
+    V u = t * (t - vconst<V>(1.0f));
+    return vconst<V>(30.0f) * u * u;
+}
+
+// Общая часть градиентного шума: скалярные произведения градиентов углов на
+// смещения, квинтик-интерполяция и (при Deriv) аналитические производные.
+template<bool Deriv, typename V>
+inline V gradientBlend(V fx0, V fy0, V fx1, V fy1, V g00x, V g00y, V g10x, V g10y,
+                       V g01x, V g01y, V g11x, V g11y, float scale, V* dx, V* dy) {
+    V n00 = g00x * fx0 + g00y * fy0;
+    V n10 = g10x * fx1 + g10y * fy0;
+    V n01 = g01x * fx0 + g01y * fy1;
+    V n11 = g11x * fx1 + g11y * fy1;
+
+    V ux = fade(fx0), uy = fade(fy0);
+    V nx0 = mix(n00, n10, ux);
+    V nx1 = mix(n01, n11, ux);
+
+    if constexpr (Deriv) {
+        // n = mix(a, b, uy), a = mix(n00, n10, ux), b = mix(n01, n11, ux)
+        V dux = fadeDeriv(fx0), duy = fadeDeriv(fy0);
+        V dax = mix(g00x, g10x, ux) + dux * (n10 - n00);
+        V dbx = mix(g01x, g11x, ux) + dux * (n11 - n01);
+        V day = mix(g00y, g10y, ux);
+        V dby = mix(g01y, g11y, ux);
+        *dx = vconst<V>(scale) * mix(dax, dbx, uy);
+        *dy = vconst<V>(scale) * (mix(day, dby, uy) + duy * (nx1 - nx0));
+    }
+    return vconst<V>(scale) * mix(nx0, nx1, uy);
+}
+
+// Классический шум Перлина 2D (как glm::perlin). При Deriv = true
+// дополнительно возвращает аналитические dn/dpx, dn/dpy; значение считается теми же операциями,
+// что и без производных, поэтому совпадает побитово.
+template<bool Deriv, typename V>
+inline V perlin2(V px, V py, V* dx = nullptr, V* dy = nullptr) {
+    V ix0 = vfloor(px), iy0 = vfloor(py);
+    V fx0 = px - ix0, fy0 = py - iy0;
+    V fx1 = fx0 - vconst<V>(1.0f), fy1 = fy0 - vconst<V>(1.0f);
+    V ix1 = ix0 + vconst<V>(1.0f), iy1 = iy0 + vconst<V>(1.0f);
+
+    // glm::mod(Pi, 289): a - b * floor(a / b)
+    const V m = vconst<V>(289.0f);
+    ix0 = ix0 - m * vfloor(ix0 / m);  ix1 = ix1 - m * vfloor(ix1 / m);
+    iy0 = iy0 - m * vfloor(iy0 / m);  iy1 = iy1 - m * vfloor(iy1 / m);
+
+    V px0 = permute(ix0), px1 = permute(ix1);
+    V g00x, g00y, g10x, g10y, g01x, g01y, g11x, g11y;
+    perlinGrad(permute(px0 + iy0), g00x, g00y);
+    perlinGrad(permute(px1 + iy0), g10x, g10y);
+    perlinGrad(permute(px0 + iy1), g01x, g01y);
+    perlinGrad(permute(px1 + iy1), g11x, g11y);
+
+    return gradientBlend<Deriv>(fx0, fy0, fx1, fy1, g00x, g00y, g10x, g10y,
+                                g01x, g01y, g11x, g11y, 2.3f, dx, dy);
+}
+
+// Шум Перлина с сидом: хеш угла — две выборки из перестановки, градиент —
+// из таблицы сида. Решётка периодична с шагом 256, координаты
+// сворачиваются точно (степень двойки), так что большие |p| не теряют
+// младшие биты целой части. Единичные градиенты дают |n| <= sqrt(2)/2,
+// множитель sqrt(2) приводит к ~[-1, 1].
+template<bool Deriv, typename V>
+inline V seededPerlin2(const NoiseTables& t, V px, V py, V* dx = nullptr, V* dy = nullptr) {
+    V ix0 = vfloor(px), iy0 = vfloor(py);
+    V fx0 = px - ix0, fy0 = py - iy0;
+    V fx1 = fx0 - vconst<V>(1.0f), fy1 = fy0 - vconst<V>(1.0f);
+
+    // i mod 256 в [0, 255]; i + 1 <= 256 и a + i + 1 <= 511 — в пределах perm
+    const V m = vconst<V>(256.0f), invM = vconst<V>(1.0f / 256.0f);
+    ix0 = ix0 - m * vfloor(ix0 * invM);
+    iy0 = iy0 - m * vfloor(iy0 * invM);
+    V one = vconst<V>(1.0f), iy1 = iy0 + one;
+
+    V a = vgather(t.perm, ix0), b = vgather(t.perm, ix0 + one);
+    V h00 = vgather(t.perm, a + iy0), h10 = vgather(t.perm, b + iy0);
+    V h01 = vgather(t.perm, a + iy1), h11 = vgather(t.perm, b + iy1);
+
+    return gradientBlend<Deriv>(fx0, fy0, fx1, fy1,
+        vgather(t.gradX, h00), vgather(t.gradY, h00), vgather(t.gradX, h10), vgather(t.gradY, h10),
+        vgather(t.gradX, h01), vgather(t.gradY, h01), vgather(t.gradX, h11), vgather(t.gradY, h11),
+        1.41421356f, dx, dy);
+}
+
+// Вклад одного угла симплекса: (0.5 - r^2)^4 * (g . d) и его производные
+template<bool Deriv, typename V>
+inline V simplexCorner(V dx, V dy, V gx, V gy, V& sdx, V& sdy) {
+    V t = vmax(vconst<V>(0.5f) - dx * dx - dy * dy, vconst<V>(0.0f));
+    V t2 = t * t, t4 = t2 * t2;
+    V g = gx * dx + gy * dy;
+    if constexpr (Deriv) {
+        // d/dx = t^4 gx - 8 t^3 x (g . d)
+        V k = vconst<V>(8.0f) * t2 * t * g;
+        sdx = sdx + t4 * gx - k * dx;
+        sdy = sdy + t4 * gy - k * dy;
+    }
+    return t4 * g;
+}
+
+// 2D симплекс-шум в духе OpenSimplex2 (треугольная решётка, ядро
+// (0.5 - r^2)^4, 3 угла вместо 4 у Перлина) на таблицах сида: те же
+// perm/grad и то же точное сворачивание по 256, что в seededPerlin2.
+// Направления градиентов не привязаны к осям — нет осевых артефактов.
+template<bool Deriv, typename V>
+inline V simplex2(const NoiseTables& t, V px, V py, V* dx = nullptr, V* dy = nullptr) {
+    const float F2 = 0.36602540378f, G2 = 0.21132486540f;  // (sqrt3-1)/2, (3-sqrt3)/6
+    V s = (px + py) * vconst<V>(F2);
+    V i = vfloor(px + s), j = vfloor(py + s);
+    V u = (i + j) * vconst<V>(G2);
+    V x0 = px - (i - u), y0 = py - (j - u);
+
+    // второй угол: (1, 0) под диагональю, (0, 1) над ней
+    V one = vconst<V>(1.0f), zero = vconst<V>(0.0f);
+    auto below = vlt(y0, x0);
+    V i1 = vselect(below, one, zero), j1 = one - i1;
+    V x1 = x0 - i1 + vconst<V>(G2), y1 = y0 - j1 + vconst<V>(G2);
+    V x2 = x0 - one + vconst<V>(2.0f * G2), y2 = y0 - one + vconst<V>(2.0f * G2);
+
+    const V m = vconst<V>(256.0f), invM = vconst<V>(1.0f / 256.0f);
+    i = i - m * vfloor(i * invM);
+    j = j - m * vfloor(j * invM);
+    V h0 = vgather(t.perm, i + vgather(t.perm, j));
+    V h1 = vgather(t.perm, i + i1 + vgather(t.perm, j + j1));
+    V h2 = vgather(t.perm, i + one + vgather(t.perm, j + one));
+
+    V sdx = zero, sdy = zero;
+    V n = simplexCorner<Deriv>(x0, y0, vgather(t.gradX, h0), vgather(t.gradY, h0), sdx, sdy)
+        + simplexCorner<Deriv>(x1, y1, vgather(t.gradX, h1), vgather(t.gradY, h1), sdx, sdy)
+        + simplexCorner<Deriv>(x2, y2, vgather(t.gradX, h2), vgather(t.gradY, h2), sdx, sdy);
+    const V scale = vconst<V>(SIMPLEX_SCALE);
+    if constexpr (Deriv) {
+        *dx = scale * sdx;
+        *dy = scale * sdy;
+    }
+    return scale * n;
+}
+
+// Базисы для fBm: eval(p, px, py, dx, dy) — значение и (при Deriv) производные
+struct GlmPerlinBasis {
+    template<bool Deriv, typename V>
+    static V eval(const FbmParams&, V px, V py, V* dx, V* dy) { return perlin2<Deriv>(px, py, dx, dy); }
+};
+
+struct SeededPerlinBasis {
+    template<bool Deriv, typename V>
+    static V eval(const FbmParams& p, V px, V py, V* dx, V* dy) {
+        return seededPerlin2<Deriv>(*p.tables, px, py, dx, dy);
+    }
+};
+
+struct SimplexBasis {
+    template<bool Deriv, typename V>
+    static V eval(const FbmParams& p, V px, V py, V* dx, V* dy) {
+        return simplex2<Deriv>(*p.tables, px, py, dx, dy);
+    }
+};
+
+// Знак n как множитель производной |n|: -1 при n < 0, иначе 1
+template<typename V>
+inline V signOf(V n) {
+    return vselect(vlt(n, vconst<V>(0.0f)), vconst<V>(-1.0f), vconst<V>(1.0f));
+}
+
+// Октавы [p.firstOctave, p.octaves) fBm по базису Basis, прибавленные к n
+// (и, при Deriv, к sx/sz) без нормировки; последняя — с весом p.lastWeight.
+// При Billow каждая октава берётся как 2|noise| - 1 (сумма по-прежнему
+// аддитивна). Частота и амплитуда октавы o получаются теми же
+// удвоениями/делениями пополам, что и при счёте с нуля, поэтому продолжение
+// суммы с сохранённого префикса побитово совпадает со счётом всех октав сразу.
+template<bool Deriv, typename Basis, bool Billow = false, typename V>
+inline void fbmOctaves(const FbmParams& p, V x, V z, V& n, V& sx, V& sz) {
+    float freq = p.frequency, amp = 1.0f;
+    for (int o = 0; o < p.firstOctave; ++o) {
+        freq *= 2;
+        amp *= 0.5f;
+    }
+    for (int o = p.firstOctave; o < p.octaves; ++o) {
+        V f = vconst<V>(freq), ofs = vconst<V>(p.offset);
+        V gx, gz;
+        float a = o == p.octaves - 1 ? amp * p.lastWeight : amp;
+        V v = Basis::template eval<Deriv>(p, x * f + ofs, z * f + ofs, &gx, &gz);
+        if constexpr (Billow) {
+            if constexpr (Deriv) {
+                V k = signOf(v) * vconst<V>(2.0f);
+                gx = gx * k;
+                gz = gz * k;
+            }
+            v = vabs(v) * vconst<V>(2.0f) - vconst<V>(1.0f);
+        }
+        n = n + v * vconst<V>(a);
+        if constexpr (Deriv) {
+            // d/dx perlin(x * f + ofs) = f * perlin'
+            V af = vconst<V>(a * freq);
+            sx = sx + gx * af;
+            sz = sz + gz * af;
+        }
+        freq *= 2;
+        amp *= 0.5f;
+    }
+}
+
+// fBm (или billow) и, при Deriv, его производные по x и z
+template<bool Deriv, typename Basis, bool Billow = false, typename V>
+inline V fbmEval(const FbmParams& p, V x, V z, V* dx = nullptr, V* dz = nullptr) {
+    V n = vconst<V>(0.0f), sx = n, sz = n;
+    FbmParams all = p;
+    all.firstOctave = 0;
+    fbmOctaves<Deriv, Basis, Billow>(all, x, z, n, sx, sz);
+    V maxA = vconst<V>(fbmNormalization(p));
+    if constexpr (Deriv) {
+        *dx = sx / maxA;
+        *dz = sz / maxA;
+    }
+    return n / maxA;
+}
+
+// Ridged multifractal (Musgrave): октава — (offset - |noise|)^2, умноженная
+// на вес из предыдущей октавы clamp(signal * gain, 0, 1), так что мелкие
+// детали растут только на гребнях. Производные — по цепному правилу через вес.
+constexpr float RIDGED_OFFSET = 1.0f;
+constexpr float RIDGED_GAIN   = 2.0f;
+
+template<bool Deriv, typename Basis, typename V>
+inline V ridgedEval(const FbmParams& p, V x, V z, V* dx = nullptr, V* dz = nullptr) {
+    V zero = vconst<V>(0.0f), one = vconst<V>(1.0f);
+    V sum = zero, sx = zero, sz = zero;
+    V w = one, wx = zero, wz = zero;    // вес октавы и его производные
+    float freq = p.frequency, amp = 1.0f;
+    for (int o = 0; o < p.octaves; ++o) {
+        V f = vconst<V>(freq), ofs = vconst<V>(p.offset);
+        V gx, gz;
+        float a = o == p.octaves - 1 ? amp * p.lastWeight : amp;
+        V v = Basis::template eval<Deriv>(p, x * f + ofs, z * f + ofs, &gx, &gz);
+        V r = vconst<V>(RIDGED_OFFSET) - vabs(v);
+        V r2 = r * r;
+        V s = r2 * w;
+        sum = sum + s * vconst<V>(a);
+        V ws = s * vconst<V>(RIDGED_GAIN);    // >= 0: r^2 >= 0 и w >= 0
+        if constexpr (Deriv) {
+            // ds = 2r * d(-|v|) * w + r^2 * dw, d(-|v|)/dx = -sign(v) * f * v'
+            V k = signOf(v) * r * w * vconst<V>(-2.0f * freq);
+            V dsx = k * gx + r2 * wx, dsz = k * gz + r2 * wz;
+            sx = sx + dsx * vconst<V>(a);
+            sz = sz + dsz * vconst<V>(a);
+            // вес упёрся в 1 — дальше он постоянный
+            auto free = vlt(ws, one);
+            wx = vselect(free, dsx * vconst<V>(RIDGED_GAIN), zero);
+            wz = vselect(free, dsz * vconst<V>(RIDGED_GAIN), zero);
+        }
+        w = vmin(ws, one);
+        freq *= 2;
+        amp *= 0.5f;
+    }
+    // каждая октава в [0, a], сумма в [0, maxA] -> [-1, 1]
+    V k = vconst<V>(2.0f / fbmNormalization(p));
+    if constexpr (Deriv) {
+        *dx = sx * k;
+        *dz = sz * k;
+    }
+    return sum * k - one;
+}
+
+// Hybrid multifractal (Musgrave): сигнал октавы (noise + offset) * amp
+// умножается на накопленный вес min(w, 1), вес — произведение сигналов.
+// Низины остаются гладкими, на возвышенностях деталей больше.
+constexpr float HYBRID_OFFSET = 0.7f;
+
+template<bool Deriv, typename Basis, typename V>
+inline V hybridEval(const FbmParams& p, V x, V z, V* dx = nullptr, V* dz = nullptr) {
+    V zero = vconst<V>(0.0f), one = vconst<V>(1.0f);
+    V sum = zero, sx = zero, sz = zero;
+    V w = one, wx = zero, wz = zero;
+    float freq = p.frequency, amp = 1.0f;
+    for (int o = 0; o < p.octaves; ++o) {
+        V f = vconst<V>(freq), ofs = vconst<V>(p.offset);
+        V gx, gz;
+        float a = o == p.octaves - 1 ? amp * p.lastWeight : amp;
+        V v = Basis::template eval<Deriv>(p, x * f + ofs, z * f + ofs, &gx, &gz);
+        V sig = (v + vconst<V>(HYBRID_OFFSET)) * vconst<V>(a);
+        V wc = vmin(w, one);
+        sum = sum + wc * sig;
+        if constexpr (Deriv) {
+            auto free = vlt(w, one);
+            V wcx = vselect(free, wx, zero), wcz = vselect(free, wz, zero);
+            V af = vconst<V>(a * freq);
+            V gsx = gx * af, gsz = gz * af;    // производные сигнала
+            wx = wcx * sig + wc * gsx;
+            wz = wcz * sig + wc * gsz;
+            sx = sx + wx;
+            sz = sz + wz;
+        }
+        w = wc * sig;
+        freq *= 2;
+        amp *= 0.5f;
+    }
+    // при весах 1 это fBm + offset; вычитаем offset, чтобы уровень был как у fBm
+    V maxA = vconst<V>(fbmNormalization(p));
+    if constexpr (Deriv) {
+        *dx = sx / maxA;
+        *dz = sz / maxA;
+    }
+    return sum / maxA - vconst<V>(HYBRID_OFFSET);
+}
+
+// Форма фрактала поверх базиса: eval() даёт нормированное значение и производные
+template<typename Basis> struct FbmFractal {
+    template<bool Deriv, typename V>
+    static V eval(const FbmParams& p, V x, V z, V* dx, V* dz) { return fbmEval<Deriv, Basis>(p, x, z, dx, dz); }
+};
+template<typename Basis> struct BillowFractal {
+    template<bool Deriv, typename V>
+    static V eval(const FbmParams& p, V x, V z, V* dx, V* dz) { return fbmEval<Deriv, Basis, true>(p, x, z, dx, dz); }
+};
+template<typename Basis> struct RidgedFractal {
+    template<bool Deriv, typename V>
+    static V eval(const FbmParams& p, V x, V z, V* dx, V* dz) { return ridgedEval<Deriv, Basis>(p, x, z, dx, dz); }
+};
+template<typename Basis> struct HybridFractal {
+    template<bool Deriv, typename V>
+    static V eval(const FbmParams& p, V x, V z, V* dx, V* dz) { return hybridEval<Deriv, Basis>(p, x, z, dx, dz); }
+};
+
+// Domain warping: h(p) = F(p + s * (qx(p), qz(p))), где qx, qz — fBm частоты
+// warpFrequency с разнесёнными смещениями. Сдвиг и основные октавы считаются
+// в одном проходе по вектору точек — сдвинутые координаты не покидают
+// регистров. Производные по цепному правилу:
+//   dh/dx = Fx * (1 + s * qx_x) + Fz * s * qz_x   (и так же для z)
+constexpr float WARP_DECORRELATE = 17.31f;  // смещение qz относительно qx, не кратное решётке
+
+template<typename Fractal, typename Basis> struct WarpedFractal {
+    template<bool Deriv, typename V>
+    static V eval(const FbmParams& p, V x, V z, V* dx, V* dz) {
+        FbmParams w = p;
+        w.frequency = p.warpFrequency;
+        w.octaves = fbmWarpOctaves(p);
+        w.lastWeight = 1.0f;
+        w.normOctaves = 0;
+        V ax, az, bx, bz;
+        V qx = fbmEval<Deriv, Basis>(w, x, z, &ax, &az);
+        w.offset = p.offset + WARP_DECORRELATE;
+        V qz = fbmEval<Deriv, Basis>(w, x, z, &bx, &bz);
+        V s = vconst<V>(p.warpStrength);
+        V fx, fz;
+        V h = Fractal::template eval<Deriv>(p, x + qx * s, z + qz * s, &fx, &fz);
+        if constexpr (Deriv) {
+            V one = vconst<V>(1.0f);
+            *dx = fx * (one + ax * s) + fz * (bx * s);
+            *dz = fx * (az * s) + fz * (one + bz * s);
+        }
+        return h;
+    }
+};
+
+// Хвост батча (count % Width) считается тем же векторным кодом на дополненном
+// буфере, чтобы все точки ряда проходили одинаковую арифметику
+template<bool Deriv, typename Fractal, typename V>
+void fbmRun(const FbmParams& p, const float* x, const float* z, int count,
+            float* out, float* outDx, float* outDz) {
+    constexpr int W = V::Width;
+    V dx, dz;
+    int i = 0;
+    for (; i + W <= count; i += W) {
+        Fractal::template eval<Deriv>(p, V::load(x + i), V::load(z + i), &dx, &dz).store(out + i);
+        if constexpr (Deriv) { dx.store(outDx + i); dz.store(outDz + i); }
+    }
+    if (i < count) {
+        float tx[W] = {}, tz[W] = {}, to[W], tdx[W], tdz[W];
+        for (int k = 0; k < count - i; ++k) { tx[k] = x[i + k]; tz[k] = z[i + k]; }
+        Fractal::template eval<Deriv>(p, V::load(tx), V::load(tz), &dx, &dz).store(to);
+        if constexpr (Deriv) { dx.store(tdx); dz.store(tdz); }
+        for (int k = 0; k < count - i; ++k) {
+            out[i + k] = to[k];
+            if constexpr (Deriv) { outDx[i + k] = tdx[k]; outDz[i + k] = tdz[k]; }
+        }
+    }
+}
+
+// Накопление сырых сумм октав: acc[i] += sum noise * amp (и производные).
+// Хвост — тем же векторным кодом, как в fbmRun.
+template<bool Deriv, typename Basis, bool Billow, typename V>
+void fbmAccumRun(const FbmParams& p, const float* x, const float* z, int count,
+                 float* acc, float* accDx, float* accDz) {
+    constexpr int W = V::Width;
+    int i = 0;
+    for (; i + W <= count; i += W) {
+        V n = V::load(acc + i), sx, sz;
+        if constexpr (Deriv) { sx = V::load(accDx + i); sz = V::load(accDz + i); }
+        fbmOctaves<Deriv, Basis, Billow>(p, V::load(x + i), V::load(z + i), n, sx, sz);
+        n.store(acc + i);
+        if constexpr (Deriv) { sx.store(accDx + i); sz.store(accDz + i); }
+    }
+    if (i < count) {
+        float tx[W] = {}, tz[W] = {}, tn[W] = {}, tdx[W] = {}, tdz[W] = {};
+        for (int k = 0; k < count - i; ++k) {
+            tx[k] = x[i + k]; tz[k] = z[i + k]; tn[k] = acc[i + k];
+            if constexpr (Deriv) { tdx[k] = accDx[i + k]; tdz[k] = accDz[i + k]; }
+        }
+        V n = V::load(tn), sx = V::load(tdx), sz = V::load(tdz);
+        fbmOctaves<Deriv, Basis, Billow>(p, V::load(tx), V::load(tz), n, sx, sz);
+        n.store(tn); sx.store(tdx); sz.store(tdz);
+        for (int k = 0; k < count - i; ++k) {
+            acc[i + k] = tn[k];
+            if constexpr (Deriv) { accDx[i + k] = tdx[k]; accDz[i + k] = tdz[k]; }
+        }
+    }
+}
+
+template<bool Billow, typename Basis, typename V>
+void fbmAccumAny(const FbmParams& p, const float* x, const float* z, int count,
+                 float* acc, float* accDx, float* accDz) {
+    if (accDx && accDz) fbmAccumRun<true, Basis, Billow, V>(p, x, z, count, acc, accDx, accDz);
+    else                fbmAccumRun<false, Basis, Billow, V>(p, x, z, count, acc, nullptr, nullptr);
+}
+
+// Только аддитивные (fbmAdditive): у ridged/hybrid октавы зависят от
+// предыдущих, а warping сдвигает все октавы — сырой префиксной суммы нет
+template<typename Basis, typename V>
+void fbmAccumKernel(const FbmParams& p, const float* x, const float* z, int count,
+                    float* acc, float* accDx, float* accDz) {
+    if (p.fractal == FractalType::Billow) fbmAccumAny<true, Basis, V>(p, x, z, count, acc, accDx, accDz);
+    else                                  fbmAccumAny<false, Basis, V>(p, x, z, count, acc, accDx, accDz);
+}
+
+template<typename Fractal, typename V>
+void fbmRunAny(const FbmParams& p, const float* x, const float* z, int count,
+               float* out, float* outDx, float* outDz) {
+    if (outDx && outDz) fbmRun<true, Fractal, V>(p, x, z, count, out, outDx, outDz);
+    else                fbmRun<false, Fractal, V>(p, x, z, count, out, nullptr, nullptr);
+}
+
+template<typename Fractal, typename Basis, typename V>
+void fbmRunShape(const FbmParams& p, const float* x, const float* z, int count,
+                 float* out, float* outDx, float* outDz) {
+    if (p.warpStrength != 0.0f) fbmRunAny<WarpedFractal<Fractal, Basis>, V>(p, x, z, count, out, outDx, outDz);
+    else                        fbmRunAny<Fractal, V>(p, x, z, count, out, outDx, outDz);
+}
+
+// Форма и warping выбираются один раз на батч, внутри цикла по точкам ветвлений нет
+template<typename Basis, typename V>
+void fbmKernel(const FbmParams& p, const float* x, const float* z, int count,
+               float* out, float* outDx, float* outDz) {
+    switch (p.fractal) {
+    case FractalType::Ridged: fbmRunShape<RidgedFractal<Basis>, Basis, V>(p, x, z, count, out, outDx, outDz); break;
+    case FractalType::Billow: fbmRunShape<BillowFractal<Basis>, Basis, V>(p, x, z, count, out, outDx, outDz); break;
+    case FractalType::Hybrid: fbmRunShape<HybridFractal<Basis>, Basis, V>(p, x, z, count, out, outDx, outDz); break;
+    default:                  fbmRunShape<FbmFractal<Basis>, Basis, V>(p, x, z, count, out, outDx, outDz); break;
+    }
+}
+
+
+// ---------------- Worley ----------------
+
+// Место признака клетки (cx, cz) в [0, 1)^2: целочисленный хеш, одинаковый
+// на всех уровнях SIMD
+inline void worleyFeature(int cx, int cz, uint32_t seed, float& fx, float& fz) {
+    uint32_t h = uint32_t(cx) * 0x8DA6B343u ^ uint32_t(cz) * 0xD8163841u ^ seed * 0xCB1AB31Fu;
+    h ^= h >> 16; h *= 0x7FEB352Du;
+    h ^= h >> 15; h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    fx = float(h & 0xFFFFu) * (1.0f / 65536.0f);
+    fz = float(h >> 16) * (1.0f / 65536.0f);
+}
+
+constexpr float WORLEY_FAR = 1e30f;
+
+// Квадраты F1, F2 для вектора точек (в клетках) по окну клеток [x0, x1] x [z0, z1].
+// Признак учитывается только дорожками, в чьи 3x3 клетки он попадает, поэтому
+// результат дорожки не зависит ни от соседей по вектору, ни от размера окна.
+// Masked = false — все дорожки в одной клетке, окно и есть их 3x3.
+template<bool Masked, typename V>
+inline void worleyWindow(const WorleyParams& p, V px, V pz, V cx, V cz,
+                         int x0, int x1, int z0, int z1, V& d1, V& d2) {
+    const V far = vconst<V>(WORLEY_FAR), reach = vconst<V>(1.5f);
+    const float base = 0.5f - 0.5f * p.jitter;
+    d1 = far;
+    d2 = far;
+    for (int qz = z0; qz <= z1; ++qz)
+        for (int qx = x0; qx <= x1; ++qx) {
+            float hx, hz;
+            worleyFeature(qx, qz, p.seed, hx, hz);
+            V dx = px - vconst<V>(float(qx) + base + p.jitter * hx);
+            V dz = pz - vconst<V>(float(qz) + base + p.jitter * hz);
+            V d = dx * dx + dz * dz;
+            if constexpr (Masked) {
+                V cell = vmax(vabs(vconst<V>(float(qx)) - cx), vabs(vconst<V>(float(qz)) - cz));
+                d = vselect(vlt(cell, reach), d, far);
+            }
+            d2 = vmin(d2, vmax(d1, d));
+            d1 = vmin(d1, d);
+        }
+}
+
+// Точки вектора рядом (ряд сетки) — одно общее окно на все дорожки: признаки
+// считаются раз на вектор, а не на точку. Разбросанные точки — окно 3x3 на
+// каждую дорожку, чтобы не перебирать огромное общее окно.
+template<typename V>
+inline V worleyEval(const WorleyParams& p, V x, V z) {
+    constexpr int W = V::Width;
+    V px = x * vconst<V>(p.frequency), pz = z * vconst<V>(p.frequency);
+    V cx = vfloor(px), cz = vfloor(pz);
+    float cxs[W], czs[W];
+    cx.store(cxs);
+    cz.store(czs);
+    float x0 = cxs[0], x1 = x0, z0 = czs[0], z1 = z0;
+    for (int k = 1; k < W; ++k) {
+        x0 = std::min(x0, cxs[k]); x1 = std::max(x1, cxs[k]);
+        z0 = std::min(z0, czs[k]); z1 = std::max(z1, czs[k]);
+    }
+    V d1, d2;
+    if (x0 == x1 && z0 == z1) {
+        worleyWindow<false>(p, px, pz, cx, cz, int(x0) - 1, int(x0) + 1, int(z0) - 1, int(z0) + 1, d1, d2);
+    }
+    else if ((x1 - x0 + 3.0f) * (z1 - z0 + 3.0f) <= float(9 * W)) {
+        worleyWindow<true>(p, px, pz, cx, cz, int(x0) - 1, int(x1) + 1, int(z0) - 1, int(z1) + 1, d1, d2);
+    }
+    else {
+        float r1[W], r2[W], t1[W], t2[W];
+        for (int k = 0; k < W; ++k) {
+            int qx = int(cxs[k]), qz = int(czs[k]);
+            worleyWindow<true>(p, px, pz, cx, cz, qx - 1, qx + 1, qz - 1, qz + 1, d1, d2);
+            d1.store(t1);
+            d2.store(t2);
+            r1[k] = t1[k];
+            r2[k] = t2[k];
+        }
+        d1 = V::load(r1);
+        d2 = V::load(r2);
+    }
+    switch (p.mode) {
+    case WorleyMode::F2:        return vsqrt(d2);
+    case WorleyMode::F2MinusF1: return vsqrt(d2) - vsqrt(d1);
+    default:                    return vsqrt(d1);
+    }
+}
+
+template<typename V>
+void worleyKernel(const WorleyParams& p, const float* x, const float* z, int count, float* out) {
+    constexpr int W = V::Width;
+    int i = 0;
+    for (; i + W <= count; i += W)
+        worleyEval(p, V::load(x + i), V::load(z + i)).store(out + i);
+    if (i < count) {
+        // хвост дополняется последней точкой, чтобы не расширять окно
+        float tx[W], tz[W], to[W];
+        for (int k = 0; k < W; ++k) {
+            int s = std::min(i + k, count - 1);
+            tx[k] = x[s];
+            tz[k] = z[s];
+        }
+        worleyEval(p, V::load(tx), V::load(tz)).store(to);
+        for (int k = 0; k < count - i; ++k) out[i + k] = to[k];
+    }
+}
+
+} // namespace
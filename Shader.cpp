@@ -3,7 +3,7 @@
 #include <sstream>
 #include <iostream>
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath) {
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines) {
     std::string vertexCode, fragmentCode;
     std::ifstream vShaderFile(vertexPath), fShaderFile(fragmentPath);
     if (!vShaderFile || !fShaderFile) {
@@ -12,20 +12,22 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     std::stringstream vss, fss;
     vss << vShaderFile.rdbuf(); vertexCode = vss.str();
     fss << fShaderFile.rdbuf(); fragmentCode = fss.str();
+    vertexCode = injectDefines(vertexCode, defines);
+    fragmentCode = injectDefines(fragmentCode, defines);
     const char* vCode = vertexCode.c_str();
     const char* fCode = fragmentCode.c_str();
     unsigned int vertex, fragment;
-    //  
+    // компиляция вершинного
     vertex = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertex, 1, &vCode, NULL);
     glCompileShader(vertex);
     checkCompileErrors(vertex, "VERTEX");
-    // 
+    // фрагментного
     fragment = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(fragment, 1, &fCode, NULL);
     glCompileShader(fragment);
     checkCompileErrors(fragment, "FRAGMENT");
-    // 
+    // линковка
     ID = glCreateProgram();
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
@@ -35,6 +37,14 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     glDeleteShader(fragment);
 }
 
+std::string Shader::injectDefines(const std::string& code, const std::string& defines) {
+    if (defines.empty()) return code;
+    // #version обязан быть первой директивой
+    size_t eol = code.find('\n', code.find("#version"));
+    if (eol == std::string::npos) return code;
+    return code.substr(0, eol + 1) + defines + code.substr(eol + 1);
+}
+
 void Shader::use() const {
     glUseProgram(ID);
 }
@@ -56,6 +66,9 @@ void Shader::setInt(const std::string& name, int value) const {
 void Shader::setFloat(const std::string& name, float value) const {
     glUniform1f(getUniformLocation(name), value);
 }
+void Shader::setVec2(const std::string& name, const glm::vec2& v) const {
+    glUniform2fv(getUniformLocation(name), 1, &v[0]);
+}
 void Shader::setVec3(const std::string& name, const glm::vec3& v) const {
     glUniform3fv(getUniformLocation(name), 1, &v[0]);
 }
@@ -7,17 +7,20 @@
 class Shader {
 public:
     unsigned int ID;
-    Shader(const char* vertexPath, const char* fragmentPath);
+    // defines вставляются сразу после строки #version в оба шейдера
+    Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines = "");
     void use() const;
-    //    uniform
+    // утилиты для установки uniform
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int  value) const;
     void setFloat(const std::string& name, float value) const;
+    void setVec2(const std::string& name, const glm::vec2& value) const;
     void setVec3(const std::string& name, const glm::vec3& value) const;
     void setMat4(const std::string& name, const glm::mat4& mat) const;
 
 private:
     mutable std::unordered_map<std::string, int> uniformLocCache;
     int getUniformLocation(const std::string& name) const;
+    static std::string injectDefines(const std::string& code, const std::string& defines);
     void checkCompileErrors(unsigned int shader, const std::string& type) const;
 };
@@ -0,0 +1,110 @@
+#include "Simd.h"
+#include "NoiseKernels.h"
+#include "GridKernels.h"
+#include "CullKernels.h"
+#include "GraphKernels.h"
+#include <atomic>
+
+#if defined(TERRAIN_SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+const SimdKernels scalarKernels = {
+    SimdLevel::Scalar, F1::Width,
+    { &fbmKernel<SeededPerlinBasis, F1>, &fbmKernel<GlmPerlinBasis, F1>, &fbmKernel<SimplexBasis, F1> },
+    { &fbmAccumKernel<SeededPerlinBasis, F1>, &fbmAccumKernel<GlmPerlinBasis, F1>,
+      &fbmAccumKernel<SimplexBasis, F1> },
+    &worleyKernel<F1>,
+    &gradientRow<F1>,
+    &cubicBlendRow<F1>,
+    &runProgram<F1>,
+    &frustumCull<F1>,
+};
+
+SimdLevel detectSimdLevel() {
+#if defined(TERRAIN_SIMD_X86)
+    unsigned int r1[4] = {}, r7[4] = {};
+#if defined(_MSC_VER)
+    int t[4];
+    __cpuid(t, 0);
+    int maxLeaf = t[0];
+    __cpuid(t, 1);
+    for (int i = 0; i < 4; ++i) r1[i] = (unsigned)t[i];
+    if (maxLeaf >= 7) {
+        __cpuidex(t, 7, 0);
+        for (int i = 0; i < 4; ++i) r7[i] = (unsigned)t[i];
+    }
+#else
+    unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+    __cpuid(1, r1[0], r1[1], r1[2], r1[3]);
+    if (maxLeaf >= 7)
+        __cpuid_count(7, 0, r7[0], r7[1], r7[2], r7[3]);
+#endif
+    bool sse41 = (r1[2] >> 19) & 1;
+    bool fma = (r1[2] >> 12) & 1;
+    bool osxsave = (r1[2] >> 27) & 1;
+    bool avx = (r1[2] >> 28) & 1;
+    bool avx2 = (r7[1] >> 5) & 1;
+
+    // ОС должна сохранять YMM-регистры при переключении контекста
+    bool ymmSaved = false;
+    if (osxsave) {
+#if defined(_MSC_VER)
+        unsigned long long xcr0 = _xgetbv(0);
+#else
+        unsigned int lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        unsigned long long xcr0 = ((unsigned long long)hi << 32) | lo;
+#endif
+        ymmSaved = (xcr0 & 6) == 6;
+    }
+
+    if (avx && avx2 && fma && ymmSaved && simdKernelsAVX2()) return SimdLevel::AVX2;
+    if (sse41 && simdKernelsSSE41()) return SimdLevel::SSE41;
+#endif
+    return SimdLevel::Scalar;
+}
+
+std::atomic<int> activeLevel{ -1 };
+
+} // namespace
+
+SimdLevel cpuSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+SimdLevel activeSimdLevel() {
+    int l = activeLevel.load(std::memory_order_relaxed);
+    return l < 0 ? cpuSimdLevel() : SimdLevel(l);
+}
+
+void setSimdLevel(SimdLevel level) {
+    if (int(level) > int(cpuSimdLevel())) level = cpuSimdLevel();
+    activeLevel.store(int(level), std::memory_order_relaxed);
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:  return "AVX2";
+    case SimdLevel::SSE41: return "SSE4.1";
+    default:               return "Scalar";
+    }
+}
+
+const SimdKernels& simdKernels(SimdLevel level) {
+    if (int(level) > int(cpuSimdLevel())) level = cpuSimdLevel();
+    if (level == SimdLevel::AVX2)  return *simdKernelsAVX2();
+    if (level == SimdLevel::SSE41) return *simdKernelsSSE41();
+    return scalarKernels;
+}
+
+const SimdKernels& simdKernels() {
+    return simdKernels(activeSimdLevel());
+}
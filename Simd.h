@@ -0,0 +1,61 @@
+#pragma once
+#include "Noise.h"
+#include <cstdint>
+
+struct NoiseProgram;
+
+// Уровни SIMD и таблица батч-ядер с выбором по CPU во время выполнения.
+enum class SimdLevel {
+    Scalar,
+    SSE41,  // 4 float за инструкцию
+    AVX2    // 8 float за инструкцию (+FMA)
+};
+
+// Таблица ядер одного набора инструкций. Заполняется в Simd.cpp (scalar),
+// Simd_sse41.cpp и Simd_avx2.cpp — каждый файл собирается со своими флагами.
+struct SimdKernels {
+    SimdLevel level;
+    int       width;  // сэмплов за итерацию
+
+    using FbmKernel = void (*)(const FbmParams& p, const float* x, const float* z, int count,
+                               float* out, float* outDx, float* outDz);
+
+    // По индексу NoiseBasis. fbm: out[i] = нормированный fBm(x[i], z[i]) в [-1, 1];
+    // outDx/outDz (оба или ни одного) — его аналитические производные.
+    // fbmAccum: out[i] += сырые октавы [p.firstOctave, p.octaves), так же производные.
+    // p.tables должен быть заполнен для всех базисов, кроме GlmPerlin.
+    FbmKernel fbm[int(NoiseBasis::Count)];
+    FbmKernel fbmAccum[int(NoiseBasis::Count)];
+
+    // Клеточный шум, см. worleyBatch
+    void (*worley)(const WorleyParams& p, const float* x, const float* z, int count, float* out);
+
+    // Градиент одного ряда сетки центральными разностями (см. GridKernels.h)
+    void (*gradientRow)(const float* prev, const float* row, const float* next, int width,
+                        float scaleX, float scaleZ, float* gx, float* gz);
+
+    // out[x] += w[0]*r0[x] + ... + w[3]*r3[x] — вертикальный проход бикубики
+    void (*cubicBlendRow)(const float* r0, const float* r1, const float* r2, const float* r3,
+                          const float* w, int width, float* out);
+
+    // Интерпретатор NoiseProgram (см. GraphKernels.h)
+    void (*program)(const NoiseProgram& prog, const float* x, const float* z, int count, float* out,
+                    const float* const* loads, float* const* stores);
+
+    // visible[i] = AABB i хотя бы частично внутри пирамиды (см. CullKernels.h).
+    // planes — 6 плоскостей (a, b, c, d), внутри a*x + b*y + c*z + d >= 0;
+    // boxes — 6 массивов по count: minX, minY, minZ, maxX, maxY, maxZ
+    void (*frustumCull)(const float* planes, const float* const* boxes, int count, uint8_t* visible);
+};
+
+SimdLevel   cpuSimdLevel();           // максимум, поддерживаемый CPU и ОС
+SimdLevel   activeSimdLevel();
+void        setSimdLevel(SimdLevel level); // обрезается до cpuSimdLevel()
+const char* simdLevelName(SimdLevel level);
+
+const SimdKernels& simdKernels();     // таблица активного уровня
+const SimdKernels& simdKernels(SimdLevel level);
+
+// nullptr, если файл собран без поддержки набора (не x86 и т.п.)
+const SimdKernels* simdKernelsSSE41();
+const SimdKernels* simdKernelsAVX2();
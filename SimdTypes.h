@@ -0,0 +1,105 @@
+#pragma once
+// Обёртки над SIMD-регистрами для шаблонных ядер (NoiseKernels.h).
+// Подключать только из Simd*.cpp: всё лежит в анонимном пространстве имён,
+// чтобы inline-функции из AVX2-файла не склеились линкером с копиями
+// из файлов без AVX2 (иначе падение на старых CPU).
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define TERRAIN_SIMD_X86 1
+#endif
+
+// MSVC не объявляет __SSE4_1__, но разрешает интринсики без /arch
+#if defined(TERRAIN_SIMD_X86) && (defined(__SSE4_1__) || defined(_MSC_VER))
+#define TERRAIN_HAS_SSE41 1
+#endif
+#if defined(TERRAIN_SIMD_X86) && defined(__AVX2__)
+#define TERRAIN_HAS_AVX2 1
+#endif
+
+namespace {
+
+// ---------------- scalar ----------------
+struct F1 {
+    static constexpr int Width = 1;
+    using Mask = bool;
+    float v;
+
+    static F1 set1(float s) { return { s }; }
+    static F1 load(const float* p) { return { *p }; }
+    void store(float* p) const { *p = v; }
+};
+
+inline F1 operator+(F1 a, F1 b) { return { a.v + b.v }; }
+inline F1 operator-(F1 a, F1 b) { return { a.v - b.v }; }
+inline F1 operator*(F1 a, F1 b) { return { a.v * b.v }; }
+inline F1 operator/(F1 a, F1 b) { return { a.v / b.v }; }
+inline F1 vfloor(F1 a) { return { std::floor(a.v) }; }
+inline F1 vabs(F1 a) { return { std::fabs(a.v) }; }
+inline F1 vmin(F1 a, F1 b) { return { a.v < b.v ? a.v : b.v }; }
+inline F1 vmax(F1 a, F1 b) { return { a.v > b.v ? a.v : b.v }; }
+inline F1 vsqrt(F1 a) { return { std::sqrt(a.v) }; }
+inline bool vlt(F1 a, F1 b) { return a.v < b.v; }
+inline F1 vselect(bool m, F1 a, F1 b) { return m ? a : b; }
+// t[idx] по каждой полосе; idx — целые неотрицательные значения в float
+inline F1 vgather(const float* t, F1 idx) { return { t[int(idx.v)] }; }
+
+#if defined(TERRAIN_HAS_SSE41)
+// ---------------- SSE4.1 ----------------
+struct F4 {
+    static constexpr int Width = 4;
+    struct Mask { __m128 m; };
+    __m128 v;
+
+    static F4 set1(float s) { return { _mm_set1_ps(s) }; }
+    static F4 load(const float* p) { return { _mm_loadu_ps(p) }; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+};
+
+inline F4 operator+(F4 a, F4 b) { return { _mm_add_ps(a.v, b.v) }; }
+inline F4 operator-(F4 a, F4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline F4 operator*(F4 a, F4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline F4 operator/(F4 a, F4 b) { return { _mm_div_ps(a.v, b.v) }; }
+inline F4 vfloor(F4 a) { return { _mm_floor_ps(a.v) }; }
+inline F4 vabs(F4 a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+inline F4 vmin(F4 a, F4 b) { return { _mm_min_ps(a.v, b.v) }; }
+inline F4 vmax(F4 a, F4 b) { return { _mm_max_ps(a.v, b.v) }; }
+inline F4 vsqrt(F4 a) { return { _mm_sqrt_ps(a.v) }; }
+inline F4::Mask vlt(F4 a, F4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline F4 vselect(F4::Mask m, F4 a, F4 b) { return { _mm_blendv_ps(b.v, a.v, m.m) }; }
+inline F4 vgather(const float* t, F4 idx) {
+    // в SSE нет gather — по полосам
+    alignas(16) int i[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(i), _mm_cvttps_epi32(idx.v));
+    return { _mm_setr_ps(t[i[0]], t[i[1]], t[i[2]], t[i[3]]) };
+}
+#endif
+
+#if defined(TERRAIN_HAS_AVX2)
+// ---------------- AVX2 ----------------
+struct F8 {
+    static constexpr int Width = 8;
+    struct Mask { __m256 m; };
+    __m256 v;
+
+    static F8 set1(float s) { return { _mm256_set1_ps(s) }; }
+    static F8 load(const float* p) { return { _mm256_loadu_ps(p) }; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+
+inline F8 operator+(F8 a, F8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+inline F8 operator-(F8 a, F8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+inline F8 operator*(F8 a, F8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+inline F8 operator/(F8 a, F8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+inline F8 vfloor(F8 a) { return { _mm256_floor_ps(a.v) }; }
+inline F8 vabs(F8 a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) }; }
+inline F8 vmin(F8 a, F8 b) { return { _mm256_min_ps(a.v, b.v) }; }
+inline F8 vmax(F8 a, F8 b) { return { _mm256_max_ps(a.v, b.v) }; }
+inline F8 vsqrt(F8 a) { return { _mm256_sqrt_ps(a.v) }; }
+inline F8::Mask vlt(F8 a, F8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+inline F8 vselect(F8::Mask m, F8 a, F8 b) { return { _mm256_blendv_ps(b.v, a.v, m.m) }; }
+inline F8 vgather(const float* t, F8 idx) { return { _mm256_i32gather_ps(t, _mm256_cvttps_epi32(idx.v), 4) }; }
+#endif
+
+} // namespace
@@ -0,0 +1,27 @@
+// Ядра AVX2. MSVC: /arch:AVX2 только для этого файла (см. vcxproj);
+// GCC/Clang: -mavx2 (без -mfma: сжатие a*b+c в FMA меняет округление
+// относительно scalar-пути). Вызываются только после проверки CPU в Simd.cpp.
+#include "Simd.h"
+#include "NoiseKernels.h"
+#include "GridKernels.h"
+#include "CullKernels.h"
+#include "GraphKernels.h"
+
+#if defined(TERRAIN_HAS_AVX2)
+namespace {
+const SimdKernels avx2Kernels = {
+    SimdLevel::AVX2, F8::Width,
+    { &fbmKernel<SeededPerlinBasis, F8>, &fbmKernel<GlmPerlinBasis, F8>, &fbmKernel<SimplexBasis, F8> },
+    { &fbmAccumKernel<SeededPerlinBasis, F8>, &fbmAccumKernel<GlmPerlinBasis, F8>,
+      &fbmAccumKernel<SimplexBasis, F8> },
+    &worleyKernel<F8>,
+    &gradientRow<F8>,
+    &cubicBlendRow<F8>,
+    &runProgram<F8>,
+    &frustumCull<F8>,
+};
+}
+const SimdKernels* simdKernelsAVX2() { return &avx2Kernels; }
+#else
+const SimdKernels* simdKernelsAVX2() { return nullptr; }
+#endif
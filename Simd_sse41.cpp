@@ -0,0 +1,25 @@
+// Ядра SSE4.1. MSVC: флаги не нужны; GCC/Clang: собирать с -msse4.1.
+#include "Simd.h"
+#include "NoiseKernels.h"
+#include "GridKernels.h"
+#include "CullKernels.h"
+#include "GraphKernels.h"
+
+#if defined(TERRAIN_HAS_SSE41)
+namespace {
+const SimdKernels sse41Kernels = {
+    SimdLevel::SSE41, F4::Width,
+    { &fbmKernel<SeededPerlinBasis, F4>, &fbmKernel<GlmPerlinBasis, F4>, &fbmKernel<SimplexBasis, F4> },
+    { &fbmAccumKernel<SeededPerlinBasis, F4>, &fbmAccumKernel<GlmPerlinBasis, F4>,
+      &fbmAccumKernel<SimplexBasis, F4> },
+    &worleyKernel<F4>,
+    &gradientRow<F4>,
+    &cubicBlendRow<F4>,
+    &runProgram<F4>,
+    &frustumCull<F4>,
+};
+}
+const SimdKernels* simdKernelsSSE41() { return &sse41Kernels; }
+#else
+const SimdKernels* simdKernelsSSE41() { return nullptr; }
+#endif
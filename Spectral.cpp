@@ -0,0 +1,171 @@
+#include "Spectral.h"
+#include "Heightfield.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using Complex = std::complex<float>;
+
+namespace {
+
+// БПФ длины n по смешанным основаниям (Кули-Тьюки, рекурсивно, вне места).
+// Таблица поворотов и разложение n считаются один раз на размер.
+class FftPlan {
+public:
+    explicit FftPlan(int n) : N(n), tw(n) {
+        for (int m = n, p = 2; m > 1; ) {
+            if (m % 4 == 0) { factors.push_back(4); m /= 4; continue; }
+            while (m % p) p = p * p > m ? m : p + 1;
+            factors.push_back(p);
+            m /= p;
+        }
+        const double pi2 = 6.283185307179586;
+        for (int j = 0; j < n; ++j)
+            tw[j] = Complex(float(std::cos(pi2 * j / n)), float(std::sin(pi2 * j / n)));
+    }
+
+    // Обратное преобразование без 1/n: data[k] = sum_j data[j] * e^(2 pi i jk / n)
+    void inverse(Complex* data, std::vector<Complex>& scratch) const {
+        scratch.resize(size_t(N) * 2);
+        Complex* out = scratch.data();
+        run(data, 1, out, N, 0, out + N);
+        std::copy(out, out + N, data);
+    }
+
+private:
+    int N;
+    std::vector<int> factors;
+    std::vector<Complex> tw;
+
+    void run(const Complex* in, int stride, Complex* out, int n, int level, Complex* tmp) const {
+        if (n == 1) { out[0] = in[0]; return; }
+        int p = factors[level], m = n / p, step = N / n;
+        for (int r = 0; r < p; ++r)
+            run(in + size_t(r) * stride, stride * p, out + size_t(r) * m, m, level + 1, tmp);
+        // r * k * step < N: поворот w^(rk) без остатка по модулю
+        if (p == 2) {
+            for (int k = 0; k < m; ++k) {
+                Complex a = out[k], b = mul(out[k + m], tw[size_t(k) * step]);
+                out[k] = a + b;
+                out[k + m] = a - b;
+            }
+            return;
+        }
+        if (p == 4) {
+            for (int k = 0; k < m; ++k) {
+                size_t t = size_t(k) * step;
+                Complex a = out[k], b = mul(out[k + m], tw[t]);
+                Complex c = mul(out[k + 2 * m], tw[2 * t]), d = mul(out[k + 3 * m], tw[3 * t]);
+                // обратное ДПФ-4: множитель i вместо -i
+                Complex s0 = a + c, s1 = a - c, s2 = b + d;
+                Complex s3(-(b.imag() - d.imag()), b.real() - d.real());   // i * (b - d)
+                out[k] = s0 + s2;
+                out[k + m] = s1 + s3;
+                out[k + 2 * m] = s0 - s2;
+                out[k + 3 * m] = s1 - s3;
+            }
+            return;
+        }
+        // простое основание — прямым ДПФ
+        for (int k = 0; k < m; ++k) {
+            for (int r = 0; r < p; ++r)
+                tmp[r] = mul(out[size_t(r) * m + k], tw[size_t(r) * k * step]);
+            for (int q = 0; q < p; ++q) {
+                Complex s = tmp[0];
+                for (int r = 1; r < p; ++r) s += mul(tmp[r], tw[size_t(r) * q * m * step % N]);
+                out[size_t(q) * m + k] = s;
+            }
+        }
+    }
+
+    // без проверок на inf/nan из operator* (там вызов __mulsc3)
+    static Complex mul(Complex a, Complex b) {
+        return Complex(a.real() * b.real() - a.imag() * b.imag(),
+                       a.real() * b.imag() + a.imag() * b.real());
+    }
+};
+
+// Гауссова пара по частоте и сиду: целочисленный хеш + Бокс-Мюллер
+Complex spectralNoise(int fx, int fz, uint32_t seed) {
+    auto hash = [](uint32_t h) {
+        h ^= h >> 16; h *= 0x7FEB352Du;
+        h ^= h >> 15; h *= 0x846CA68Bu;
+        h ^= h >> 16;
+        return h;
+    };
+    uint32_t h = hash(uint32_t(fx) * 0x9E3779B1u ^ uint32_t(fz) * 0x85EBCA77u ^ seed * 0xC2B2AE3Du);
+    uint32_t g = hash(h ^ 0x27D4EB2Fu);
+    float u1 = (float(h >> 8) + 0.5f) * (1.0f / 16777216.0f);
+    float u2 = float(g >> 8) * (1.0f / 16777216.0f);
+    float r = std::sqrt(-2.0f * std::log(u1)), a = 6.2831853f * u2;
+    return Complex(r * std::cos(a), r * std::sin(a));
+}
+
+} // namespace
+
+bool spectralField(Heightfield& hf, const SpectralParams& p, ThreadPool& pool,
+                   const std::atomic<bool>* cancel) {
+    int W = hf.width(), D = hf.depth();
+    int P = std::max(W - 1, 1), Q = std::max(D - 1, 1);
+    auto cancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+
+    // 1) спектр: частота в периодах на больший размер тайла
+    float Lmax = float(std::max(P, Q));
+    float kMax = p.maxCycles > 0 ? float(p.maxCycles) : 0.5f * Lmax;
+    // полоса не пустая: иначе все коэффициенты нулевые и поле молча плоское.
+    // Кольцо шириной в период внутри Найквиста всегда задевает узел решётки.
+    float kMin = std::min(float(p.minCycles), 0.5f * Lmax - 1.0f);
+    kMax = std::max(kMax, kMin + 1.0f);
+    std::vector<Complex> field(size_t(P) * Q);
+    std::vector<double> power(Q, 0.0);
+    pool.parallelFor(0, Q, std::max(1, 16384 / P), [&](int z0, int z1) {
+        for (int kz = z0; kz < z1; ++kz) {
+            int fz = kz <= Q / 2 ? kz : kz - Q;
+            Complex* row = &field[size_t(kz) * P];
+            for (int kx = 0; kx < P; ++kx) {
+                int fx = kx <= P / 2 ? kx : kx - P;
+                float k = std::sqrt(float(fx) * fx * (Lmax / P) * (Lmax / P) + float(fz) * fz * (Lmax / Q) * (Lmax / Q));
+                if (k < 0.5f || k < kMin || k > kMax) { row[kx] = 0.0f; continue; }
+                float amp = std::pow(k, -p.beta);
+                row[kx] = spectralNoise(fx, fz, p.seed) * amp;
+                power[kz] += double(amp) * amp;
+            }
+        }
+        });
+    if (cancelled()) return false;
+
+    // 2) обратное БПФ: строки, затем столбцы — каждая линия независима
+    FftPlan rowPlan(P), colPlan(Q);
+    pool.parallelFor(0, Q, std::max(1, 4096 / P), [&](int z0, int z1) {
+        if (cancelled()) return;
+        std::vector<Complex> scratch;
+        for (int z = z0; z < z1; ++z) rowPlan.inverse(&field[size_t(z) * P], scratch);
+        });
+    if (cancelled()) return false;
+    pool.parallelFor(0, P, std::max(1, 4096 / Q), [&](int x0, int x1) {
+        if (cancelled()) return;
+        std::vector<Complex> col(Q), scratch;
+        for (int x = x0; x < x1; ++x) {
+            for (int z = 0; z < Q; ++z) col[z] = field[size_t(z) * P + x];
+            colPlan.inverse(col.data(), scratch);
+            for (int z = 0; z < Q; ++z) field[size_t(z) * P + x] = col[z];
+        }
+        });
+    if (cancelled()) return false;
+
+    // 3) Re / СКО -> узлы сетки с повтором периода на краях
+    double total = 0.0;
+    for (double s : power) total += s;   // фиксированный порядок — не зависит от потоков
+    float scale = total > 0.0 ? float(0.25 / std::sqrt(total)) : 0.0f;
+    pool.parallelFor(0, D, rowBand(W), [&](int z0, int z1) {
+        for (int z = z0; z < z1; ++z) {
+            const Complex* src = &field[size_t(z % Q) * P];
+            float* dst = hf.row(z);
+            for (int x = 0; x < W; ++x)
+                dst[x] = std::min(std::max(src[x % P].real() * scale, -1.0f), 1.0f);
+        }
+        });
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+class Heightfield;
+class ThreadPool;
+
+// Спектральный синтез: поле — действительная часть обратного 2D БПФ спектра
+// со случайными гауссовыми коэффициентами и амплитудой ~ 1/f^beta. Вся сетка
+// за O(N^2 log N) вместо O(N^2 * octaves) у шума по точкам.
+struct SpectralParams {
+    float    beta = 1.0f;    // амплитуда ~ 1/f^beta; 1 — как fBm (амплитуда x0.5 на октаву)
+    uint32_t seed = 0;
+    int      minCycles = 1;  // полоса пропускания в периодах на тайл
+    int      maxCycles = 0;  // 0 — до частоты Найквиста; не уже периода выше minCycles
+};
+
+// Поле периодично с периодом (W-1) x (D-1) узлов: последний ряд/столбец
+// повторяет первый, и копии тайла стыкуются без шва. Коэффициент частоты
+// (fx, fz) зависит только от seed и самой частоты, поэтому тайлы разного
+// разрешения с одним seed совпадают по общим частотам.
+// Значения нормированы к СКО 0.25 и обрезаны до [-1, 1].
+// Строки и столбцы БПФ — параллельно; любой размер (смешанные основания,
+// простые множители — прямым ДПФ), быстрее всего при W-1 = 2^k.
+bool spectralField(Heightfield& hf, const SpectralParams& p, ThreadPool& pool,
+                   const std::atomic<bool>* cancel = nullptr);
@@ -1,189 +1,559 @@
 #include "Terrain.h"
 #include "Shader.h"
-#include <glm/gtc/noise.hpp>
+#include "DiamondSquare.h"
+#include "Frustum.h"
+#include "HeightGenerator.h"
+#include "NoiseGraph.h"
+#include "Spectral.h"
+#include "ThreadPool.h"
+#include "VertexLayout.h"
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <vector>
 
-Terrain::Terrain(int gridSize, float worldSize)
-    : GRID_SIZE(gridSize), WORLD_SIZE(worldSize)
+Terrain::Terrain(int gridSize, float worldSize, VertexFormat format)
+    : GRID_SIZE(gridSize), WORLD_SIZE(worldSize), EBO(0), indexChunk(0), indexCount(0), format(format),
+      vboBytes(0), vboFormat(-1)
 {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
 }
 
 Terrain::~Terrain() {
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        stopWorker = true;
+        cancelJob = true;
+    }
+    asyncCv.notify_all();
+    if (worker.joinable()) worker.join();
+
+    releaseIndices();
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
 }
 
-void Terrain::generate(float amplitude, float frequency, int octaves, float offset) {
-    int N = GRID_SIZE;
-    vertices.clear();
-    vertices.reserve(N * N * 14);
-
-    // 1)  , -, UV, -
-    for (int z = 0; z < N; ++z) {
-        for (int x = 0; x < N; ++x) {
-            float u = float(x) / (N - 1);
-            float v = float(z) / (N - 1);
-            float xPos = (u - 0.5f) * WORLD_SIZE;
-            float zPos = (v - 0.5f) * WORLD_SIZE;
-
-            // Perlin noise
-            float n = 0, freq = frequency, amp = 1, maxA = 0;
-            for (int o = 0; o < octaves; ++o) {
-                n += glm::perlin(glm::vec2(xPos * freq + offset, zPos * freq + offset)) * amp;
-                maxA += amp;
-                freq *= 2;
-                amp *= 0.5f;
+// Индексы зависят только от размера тайла: один EBO на размер,
+// общий для всех тайлов всех Terrain, живёт, пока на него есть ссылки
+namespace {
+struct SharedIndexBuffer {
+    GLuint ebo = 0;
+    size_t count = 0;
+    int    refs = 0;
+};
+}
+
+static std::map<int, SharedIndexBuffer>& indexBuffers() {
+    static std::map<int, SharedIndexBuffer> buffers;
+    return buffers;
+}
+
+void Terrain::acquireIndices(int C) {
+    if (indexChunk == C) return;
+    releaseIndices();
+
+    // привязка EBO — состояние VAO: вяжем к своему, а не к случайно активному
+    glBindVertexArray(VAO);
+    SharedIndexBuffer& ib = indexBuffers()[C];
+    if (ib.refs++ == 0) {
+        // первый Terrain этого размера тайла строит и заливает индексы
+        int V = C + 1;
+        std::vector<uint16_t> indices;
+        indices.reserve(size_t(C) * C * 6);
+        for (int z = 0; z < C; ++z) {
+            for (int x = 0; x < C; ++x) {
+                uint16_t i = uint16_t(z * V + x);
+                indices.insert(indices.end(), {
+                    i, uint16_t(i + 1), uint16_t(i + V),
+                    uint16_t(i + 1), uint16_t(i + V + 1), uint16_t(i + V)
+                    });
             }
-            n = (n / maxA)* 0.5f + 0.5f;
-            n = pow(n, 2.0f);
-            float yPos = n * amplitude;
-
-            // push: pos
-            vertices.insert(vertices.end(), { xPos, yPos, zPos });
-            // normal placeholder
-            vertices.insert(vertices.end(), { 0.0f, 0.0f, 0.0f });
-            // uv (=10)
-            vertices.insert(vertices.end(), { u * 10.0f, v * 10.0f });
-            // tangent placeholder
-            vertices.insert(vertices.end(), { 0.0f, 0.0f, 0.0f });
-            // bitangent placeholder
-            vertices.insert(vertices.end(), { 0.0f, 0.0f, 0.0f });
         }
+        glGenBuffers(1, &ib.ebo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib.ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t),
+            indices.data(), GL_STATIC_DRAW);
+        ib.count = indices.size();
     }
+    EBO = ib.ebo;
+    indexCount = ib.count;
+    indexChunk = C;
 
-    // 2) 
-    indices.clear();
-    for (int z = 0; z < N - 1; ++z) {
-        for (int x = 0; x < N - 1; ++x) {
-            unsigned int i = z * N + x;
-            indices.insert(indices.end(), {
-                i, i + 1, i + N,
-                i + 1, i + N + 1, i + N
-                });
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBindVertexArray(0);
+}
+
+void Terrain::releaseIndices() {
+    if (indexChunk == 0) return;
+    auto it = indexBuffers().find(indexChunk);
+    if (--it->second.refs == 0) {
+        glDeleteBuffers(1, &it->second.ebo);
+        indexBuffers().erase(it);
+    }
+    EBO = 0;
+    indexChunk = 0;
+    indexCount = 0;
+}
+
+// Граф пресета: fbm — базовый фрактал (уже отсечённый по сетке); ridged-слой
+// отсекается так же, если spacing > 0
+static NoiseGraph buildTerrainGraph(const TerrainParams& p, const FbmParams& fbm, float spacing) {
+    NoiseGraph g;
+    NoiseGraph::Node base = g.fractal(fbm);
+    if (p.graph == TerrainGraph::Mountains) {
+        FbmParams ridged = fbm;
+        ridged.fractal = FractalType::Ridged;
+        ridged.frequency = p.frequency * 1.7f;
+        ridged.octaves = ridged.normOctaves = p.octaves;
+        ridged.lastWeight = 1.0f;
+        ridged.seed = fbm.seed + 1;
+        FbmParams mask = fbm;
+        mask.fractal = FractalType::Fbm;
+        mask.warpStrength = 0.0f;
+        mask.frequency = p.frequency * 0.35f;
+        mask.octaves = 2;
+        mask.normOctaves = 0;
+        mask.lastWeight = 1.0f;
+        mask.seed = fbm.seed + 2;
+        NoiseGraph::Node m = g.clamp(g.affine(g.fractal(mask), 2.5f, 0.5f), 0.0f, 1.0f);
+        if (spacing > 0.0f) ridged = fbmClampToSpacing(ridged, spacing);
+        NoiseGraph::Node h = g.blend(base, g.fractal(ridged), m);
+        NoiseGraph::Node s = g.affine(h, 0.5f, 0.5f);
+        g.affine(g.mul(s, s), p.amplitude, 0.0f);
+    }
+    else if (p.graph == TerrainGraph::Plateaus) {
+        // F1 Worley: плоская вершина в середине клетки, обрыв к её границам
+        WorleyParams cells{ p.frequency * 1.5f };
+        cells.seed = fbm.seed;
+        NoiseGraph::Node top = g.curve(g.cellular(cells), { 0.0f, 0.45f, 0.6f, 0.9f }, { 1.0f, 1.0f, 0.25f, 0.0f });
+        NoiseGraph::Node s = g.clamp(g.affine(base, 0.5f, 0.5f), 0.0f, 1.0f);
+        g.affine(g.add(g.affine(top, 0.75f, 0.0f), g.affine(s, 0.35f, 0.0f)), p.amplitude, 0.0f);
+    }
+    else {
+        NoiseGraph::Node s = g.clamp(g.affine(base, 0.5f, 0.5f), 0.0f, 1.0f);
+        NoiseGraph::Node c = g.curve(s, { 0.0f, 0.35f, 0.55f, 1.0f }, { 0.0f, 0.1f, 0.6f, 1.0f });
+        g.affine(g.terrace(c, 6, 0.3f), p.amplitude, 0.0f);
+    }
+    return g;
+}
+
+bool Terrain::generateHeights(Heightfield& hf, const TerrainParams& p, GenerationStats& stats,
+                              const std::atomic<bool>* cancel) {
+    auto t0 = std::chrono::steady_clock::now();
+    int N = GRID_SIZE;
+    hf.resize(N, N, WORLD_SIZE / (N - 1), -0.5f * WORLD_SIZE, -0.5f * WORLD_SIZE);
+    FbmParams fbm{ p.frequency, p.offset, p.octaves };
+    fbm.basis = p.basis;
+    fbm.fractal = p.fractal;
+    fbm.warpStrength = p.warpStrength;
+    fbm.warpFrequency = p.warpFrequency;
+    fbm.seed = uint32_t(p.seed);
+    if (p.clampOctaves)
+        fbm = fbmClampToSpacing(fbm, hf.spacing());
+    ThreadPool& pool = ThreadPool::shared();
+
+    bool done;
+    if (p.engine == TerrainEngine::Spectral) {
+        SpectralParams sp;
+        sp.beta = p.spectralBeta;
+        sp.seed = uint32_t(p.seed);
+        sp.minCycles = p.spectralMinCycles;
+        sp.maxCycles = p.spectralMaxCycles;
+        done = generateSpectralHeights(hf, sp, p.amplitude, pool, cancel, &stats);
+        if (done) hf.computeGradients(pool);
+    }
+    else if (p.engine == TerrainEngine::DiamondSquare) {
+        DiamondSquareParams dp;
+        dp.roughness = p.roughness;
+        dp.seed = uint32_t(p.seed);
+        done = generateDiamondSquareHeights(hf, dp, p.amplitude, pool, cancel, &stats);
+        if (done) hf.computeGradients(pool);
+    }
+    else if (p.graph != TerrainGraph::None) {
+        // пересчитываются только узлы, чьи параметры изменились, и всё ниже них
+        NoiseGraph graph = buildTerrainGraph(p, fbm, p.clampOctaves ? hf.spacing() : 0.0f);
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            done = graphCache.generate(hf, graph, pool, cancel, &stats);
         }
+        if (done) hf.computeGradients(pool);
+    }
+    else if (p.multiResolution) {
+        // градиенты — разностями по сетке, здесь же, а не в GL-потоке
+        done = generateFbmHeightsMultiRes(hf, fbm, p.amplitude, pool, FBM_MULTIRES_TOLERANCE,
+                                          cancel, &stats);
+        if (done) hf.computeGradients(pool);
+    }
+    else {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        done = fbmCache.generate(hf, fbm, p.amplitude, pool, cancel, &stats);
+    }
+    stats.milliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+    return done;
+}
+
+void Terrain::generate(const TerrainParams& params) {
+    {
+        // синхронный результат важнее незавершённых фоновых
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        hasPending = hasReady = false;
+        cancelJob = true;
+        ++requestSerial;
     }
-    indexCount = indices.size();
 
-    // 3)    
-    computeNormals();
-    computeTangents();
+    // 1) высоты (без GL)
+    generateHeights(heightfield, params, currentStats);
+    current = params;
 
-    // 4)   
-    setupMesh();
+    // 2) меш из сетки высот
+    buildMesh();
 }
 
-void Terrain::computeNormals() {
-    int N = GRID_SIZE;
-    std::vector<glm::vec3> norms(N * N, glm::vec3(0.0f));
+void Terrain::requestGenerate(const TerrainParams& params) {
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        pendingParams = params;
+        hasPending = true;
+        cancelJob = true;  // текущая работа устарела
+        ++requestSerial;
+        if (!worker.joinable())
+            worker = std::thread(&Terrain::workerLoop, this);
+    }
+    asyncCv.notify_one();
+}
 
-    auto pos = [&](int idx) {
-        return glm::vec3(
-            vertices[idx * 14 + 0],
-            vertices[idx * 14 + 1],
-            vertices[idx * 14 + 2]
-        );
-        };
+void Terrain::workerLoop() {
+    std::unique_lock<std::mutex> lock(asyncMutex);
+    for (;;) {
+        asyncCv.wait(lock, [this] { return stopWorker || hasPending; });
+        if (stopWorker) return;
 
-    for (size_t i = 0; i < indices.size(); i += 3) {
-        int a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
-        glm::vec3 v0 = pos(a), v1 = pos(b), v2 = pos(c);
-        glm::vec3 n = glm::normalize(glm::cross(v2 - v0, v1 - v0));
-        norms[a] += n;
-        norms[b] += n;
-        norms[c] += n;
+        TerrainParams p = pendingParams;
+        unsigned serial = requestSerial;
+        hasPending = false;
+        cancelJob = false;
+        working = true;
+        lock.unlock();
+
+        bool done = generateHeights(backField, p, backStats, &cancelJob);
+
+        lock.lock();
+        working = false;
+        // отменённое или уже перекрытое новым запросом не публикуем
+        if (done && serial == requestSerial && !stopWorker) {
+            std::swap(backField, readyField);
+            readyParams = p;
+            readyStats = backStats;
+            hasReady = true;
+        }
+        idleCv.notify_all();
     }
-    for (int i = 0; i < N * N; ++i) {
-        glm::vec3 n = glm::normalize(norms[i]);
-        float* f = &vertices[i * 14] + 3;
-        f[0] = n.x; f[1] = n.y; f[2] = n.z;
+}
+
+bool Terrain::update() {
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        if (!hasReady) return false;
+        // readyField worker больше не трогает — забираем её, старую отдаём ему
+        std::swap(heightfield, readyField);
+        current = readyParams;
+        currentStats = readyStats;
+        hasReady = false;
     }
+    buildMesh();
+    return true;
 }
 
-void Terrain::computeTangents() {
-    int N = GRID_SIZE;
-    std::vector<glm::vec3> tans(N * N, glm::vec3(0.0f));
-    std::vector<glm::vec3> bits(N * N, glm::vec3(0.0f));
-
-    auto pos = [&](int idx) {
-        float* f = &vertices[idx * 14];
-        return glm::vec3(f[0], f[1], f[2]);
-        };
-    auto uv = [&](int idx) {
-        float* f = &vertices[idx * 14] + 6;
-        return glm::vec2(f[0], f[1]);
-        };
-    auto norm = [&](int idx) {
-        float* f = &vertices[idx * 14] + 3;
-        return glm::vec3(f[0], f[1], f[2]);
-        };
-
-    for (size_t i = 0; i < indices.size(); i += 3) {
-        int i0 = indices[i + 0], i1 = indices[i + 1], i2 = indices[i + 2];
-        glm::vec3 p0 = pos(i0), p1 = pos(i1), p2 = pos(i2);
-        glm::vec2 uv0 = uv(i0), uv1 = uv(i1), uv2 = uv(i2);
-
-        glm::vec3 e1 = p1 - p0;
-        glm::vec3 e2 = p2 - p0;
-        glm::vec2 dUV1 = uv1 - uv0;
-        glm::vec2 dUV2 = uv2 - uv0;
-
-        float r = 1.0f / (dUV1.x * dUV2.y - dUV1.y * dUV2.x);
-        glm::vec3 tangent = (e1 * dUV2.y - e2 * dUV1.y) * r;
-        glm::vec3 bitan = (e2 * dUV1.x - e1 * dUV2.x) * r;
-
-        tans[i0] += tangent;  tans[i1] += tangent;  tans[i2] += tangent;
-        bits[i0] += bitan;    bits[i1] += bitan;    bits[i2] += bitan;
-    }
-
-    for (int i = 0; i < N * N; ++i) {
-        glm::vec3 T = tans[i];
-        glm::vec3 Nrm = norm(i);
-        // 
-        T = glm::normalize(T - Nrm * glm::dot(Nrm, T));
-        glm::vec3 B = glm::normalize(glm::cross(Nrm, T));
-
-        float* f = &vertices[i * 14] + 8;
-        f[0] = T.x; f[1] = T.y; f[2] = T.z;
-        f[3] = B.x; f[4] = B.y; f[5] = B.z;
-    }
-}
-
-void Terrain::setupMesh() {
+bool Terrain::generating() const {
+    std::lock_guard<std::mutex> lock(asyncMutex);
+    return hasPending || working;
+}
+
+void Terrain::waitIdle() {
+    std::unique_lock<std::mutex> lock(asyncMutex);
+    idleCv.wait(lock, [this] { return !hasPending && !working; });
+}
+
+void Terrain::setVertexFormat(VertexFormat fmt) {
+    if (fmt == format) return;
+    format = fmt;
+    if (heightfield.size()) buildMesh();
+}
+
+void Terrain::setLod(bool enabled) {
+    if (enabled == lod) return;
+    lod = enabled;
+    if (heightfield.size()) buildMesh();
+}
+
+const char* Terrain::lodShaderDefines() {
+    return "#define TERRAIN_DERIVED_TBN\n#define TERRAIN_CDLOD\n";
+}
+
+const char* Terrain::shaderDefines(VertexFormat format) {
+    switch (format) {
+    case VertexFormat::DerivedTBN: return "#define TERRAIN_DERIVED_TBN\n";
+    case VertexFormat::Compact:    return "#define TERRAIN_DERIVED_TBN\n#define TERRAIN_COMPACT_VERTEX\n";
+    default:                       return "";
+    }
+}
+
+// Вызывает f(Layout{}) для раскладки формата
+template<typename F>
+static void withLayout(VertexFormat format, F&& f) {
+    switch (format) {
+    case VertexFormat::Full:    f(FullLayout{}); break;
+    case VertexFormat::Compact: f(CompactLayout{}); break;
+    default:                    f(LeanLayout{}); break;
+    }
+}
+
+void Terrain::buildMesh() {
+    ThreadPool& pool = ThreadPool::shared();
+    Heightfield& hf = heightfield;
+
+    // 0) градиенты: аналитические от генератора или разностями по сетке
+    if (!hf.hasGradients())
+        hf.computeGradients(pool);
+
+    // CDLOD: сетка целиком уходит в текстуру, тайлы не нужны (и не обновляются
+    // до возврата к ним — тогда syncChunk найдёт изменившиеся)
+    if (lod) {
+        cdlod.upload(hf, pool);
+        return;
+    }
+
+    // 1) индексы: один раз на размер тайла
+    acquireIndices(TERRAIN_CHUNK_CELLS);
+
+    // 2) тайлы забирают свой кусок сетки; не изменившиеся остаются как были
+    layoutChunks();
+    pool.parallelFor(0, int(tiles.size()), 1, [&](int b, int e) {
+        for (int i = b; i < e; ++i) syncChunk(tiles[i]);
+        });
+    updateTileBounds();
+
+    // 3) вершины изменившихся тайлов в раскладке текущего формата — в их диапазоны VBO
+    withLayout(format, [&](auto layout) { uploadVertices<decltype(layout)>(); });
+}
+
+void Terrain::layoutChunks() {
+    int N = GRID_SIZE, C = TERRAIN_CHUNK_CELLS, V = C + 1;
+    int n = (N - 2) / C + 1;   // N - 1 ячеек
+    if (N == tilesGrid) return;
+    tiles.assign(size_t(n) * n, TerrainChunk{});
+    for (int cz = 0; cz < n; ++cz) {
+        for (int cx = 0; cx < n; ++cx) {
+            TerrainChunk& c = tiles[size_t(cz) * n + cx];
+            c.x0 = cx * C;
+            c.z0 = cz * C;
+            c.cols = std::min(C, N - 1 - c.x0) + 1;
+            c.rows = std::min(C, N - 1 - c.z0) + 1;
+            c.baseVertex = GLint((size_t(cz) * n + cx) * V * V);
+        }
+    }
+    tilesGrid = N;
+    for (std::vector<float>& b : tileBounds) b.assign(tiles.size(), 0.0f);
+    tileVisible.assign(tiles.size(), 1);
+    visibleCount = int(tiles.size());
+}
+
+void Terrain::updateTileBounds() {
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        const TerrainChunk& c = tiles[i];
+        for (int k = 0; k < 3; ++k) {
+            tileBounds[k][i] = c.boundsMin[k];
+            tileBounds[k + 3][i] = c.boundsMax[k];
+        }
+    }
+}
+
+void Terrain::cull(const glm::mat4& viewProjection, const glm::vec3& eye, float projScale) {
+    if (lod) {
+        cdlod.select(eye, viewProjection, lodError, projScale);
+        return;
+    }
+    const float* boxes[6];
+    for (int k = 0; k < 6; ++k) boxes[k] = tileBounds[k].data();
+    visibleCount = cullBoxes(Frustum::fromMatrix(viewProjection), boxes, int(tiles.size()), tileVisible.data());
+}
+
+// Копия куска сетки в тайл, если он изменился (высоты, градиенты или геометрия)
+void Terrain::syncChunk(TerrainChunk& c) {
+    const Heightfield& hf = heightfield;
+    Heightfield& t = c.heights;
+    size_t rowBytes = size_t(c.cols) * sizeof(float);
+    bool same = t.width() == c.cols && t.depth() == c.rows && t.hasGradients() &&
+                t.spacing() == hf.spacing() && t.originX() == hf.worldX(c.x0) &&
+                t.originZ() == hf.worldZ(c.z0);
+    for (int z = 0; same && z < c.rows; ++z) {
+        same = !std::memcmp(t.row(z), hf.row(c.z0 + z) + c.x0, rowBytes) &&
+               !std::memcmp(t.gradXRow(z), hf.gradXRow(c.z0 + z) + c.x0, rowBytes) &&
+               !std::memcmp(t.gradZRow(z), hf.gradZRow(c.z0 + z) + c.x0, rowBytes);
+    }
+    if (same) return;
+
+    t.resize(c.cols, c.rows, hf.spacing(), hf.worldX(c.x0), hf.worldZ(c.z0));
+    t.allocGradients();
+    float lo = hf.row(c.z0)[c.x0], hi = lo;
+    for (int z = 0; z < c.rows; ++z) {
+        const float* h = hf.row(c.z0 + z) + c.x0;
+        std::copy(h, h + c.cols, t.row(z));
+        std::copy(hf.gradXRow(c.z0 + z) + c.x0, hf.gradXRow(c.z0 + z) + c.x0 + c.cols, t.gradXRow(z));
+        std::copy(hf.gradZRow(c.z0 + z) + c.x0, hf.gradZRow(c.z0 + z) + c.x0 + c.cols, t.gradZRow(z));
+        auto mm = std::minmax_element(h, h + c.cols);
+        lo = std::min(lo, *mm.first);
+        hi = std::max(hi, *mm.second);
+    }
+    c.boundsMin = glm::vec3(t.worldX(0), lo, t.worldZ(0));
+    c.boundsMax = glm::vec3(t.worldX(c.cols - 1), hi, t.worldZ(c.rows - 1));
+    c.dirty = true;
+}
+
+void Terrain::editHeights(int x0, int z0, int x1, int z1, const std::function<void(Heightfield&)>& fn) {
+    Heightfield& hf = heightfield;
+    if (!hf.size() || (tiles.empty() && !lod)) return;
+    ThreadPool& pool = ThreadPool::shared();
+    fn(hf);
+    hf.updateBounds(pool);
+    // центральные разности: правка задевает градиенты на узел вокруг, и
+    // только их — аналитические за пределами каймы остаются как были
+    hf.computeGradients(pool, x0 - 1, x1 + 2, z0 - 1, z1 + 2);
+    if (lod) {
+        cdlod.upload(hf, pool);  // текстура и дерево — целиком
+        return;
+    }
+
+    // сверяются только тайлы, задетые правкой с этой каймой
+    for (TerrainChunk& c : tiles) {
+        if (c.x0 + c.cols - 1 < x0 - 1 || c.x0 > x1 + 1 || c.z0 + c.rows - 1 < z0 - 1 || c.z0 > z1 + 1)
+            continue;
+        syncChunk(c);
+    }
+    updateTileBounds();
+    withLayout(format, [&](auto layout) { uploadVertices<decltype(layout)>(); });
+}
+
+template<typename Layout>
+void Terrain::packChunk(const TerrainChunk& c, typename Layout::Vertex* out) const {
+    int N = GRID_SIZE, V = TERRAIN_CHUNK_CELLS + 1;
+    const Heightfield& t = c.heights;
+    // высота в Compact — в пределах тайла: тайл не зависит от остальной сетки
+    float minH = c.boundsMin.y;
+    float invRange = c.boundsMax.y > minH ? 1.0f / (c.boundsMax.y - minH) : 0.0f;
+
+    VertexSource src;
+    for (int lz = 0; lz < V; ++lz) {
+        int z = std::min(lz, c.rows - 1);
+        const float* h = t.row(z);
+        const float* gx = t.gradXRow(z);
+        const float* gz = t.gradZRow(z);
+        for (int lx = 0; lx < V; ++lx) {
+            int x = std::min(lx, c.cols - 1);
+            src.gx = c.x0 + x;
+            src.gz = c.z0 + z;
+            src.pos = glm::vec3(t.worldX(x), h[x], t.worldZ(z));
+            // нормаль поверхности y = h(x, z): (-dh/dx, 1, -dh/dz)
+            src.normal = glm::normalize(glm::vec3(-gx[x], 1.0f, -gz[x]));
+            // uv (тайлинг=10) — по узлу всей сетки
+            src.uv = glm::vec2(src.gx, src.gz) * (10.0f / (N - 1));
+            src.heightUnorm = (h[x] - minH) * invRange;
+            Layout::pack(src, out[size_t(lz) * V + lx]);
+        }
+    }
+}
+
+template<typename Layout>
+void Terrain::uploadVertices() {
+    using Vertex = typename Layout::Vertex;
+    size_t perChunk = size_t(TERRAIN_CHUNK_CELLS + 1) * (TERRAIN_CHUNK_CELLS + 1);
+    size_t bytes = tiles.size() * perChunk * sizeof(Vertex);
+
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float),
-        vertices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned),
-        indices.data(), GL_STATIC_DRAW);
-
-    GLsizei stride = 14 * sizeof(float);
-    // aPos
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    // aNormal
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-    // aTexCoord
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
-    // aTangent
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)(8 * sizeof(float)));
-    // aBitangent
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void*)(11 * sizeof(float)));
+    // хранилище — только при смене размера/формата, атрибуты — при смене формата;
+    // после любой из них перепаковываются все тайлы
+    bool all = false;
+    if (bytes != vboBytes) {
+        glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_DYNAMIC_DRAW);
+        vboBytes = bytes;
+        all = true;
+    }
+    if (vboFormat != int(format)) {
+        // aPos/aNormal/aTexCoord[/aTangent/aBitangent] или aHeight/aNormalOct
+        Layout::apply();
+        vboFormat = int(format);
+        all = true;
+    }
+
+    std::vector<int> dirty;
+    for (int i = 0; i < int(tiles.size()); ++i)
+        if (all || tiles[i].dirty) dirty.push_back(i);
+    lastRebuilt = int(dirty.size());
+    ThreadPool& pool = ThreadPool::shared();
+
+    bool ok = dirty.empty();
+    if (dirty.size() == tiles.size()) {
+        // всё заново: пакуем прямо в отображённый буфер; INVALIDATE — драйверу
+        // не нужно ждать кадр, который ещё рисует старые вершины
+        void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped) {
+            Vertex* out = static_cast<Vertex*>(mapped);
+            pool.parallelFor(0, int(tiles.size()), 1, [&](int b, int e) {
+                for (int i = b; i < e; ++i) packChunk<Layout>(tiles[i], out + tiles[i].baseVertex);
+                });
+            ok = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+        }
+    }
+    if (!ok) {
+        // часть тайлов (или map не удался): через копию, только их диапазоны
+        std::vector<Vertex> staging(dirty.size() * perChunk);
+        pool.parallelFor(0, int(dirty.size()), 1, [&](int b, int e) {
+            for (int i = b; i < e; ++i) packChunk<Layout>(tiles[dirty[i]], &staging[size_t(i) * perChunk]);
+            });
+        for (size_t i = 0; i < dirty.size(); ++i)
+            glBufferSubData(GL_ARRAY_BUFFER, GLintptr(tiles[dirty[i]].baseVertex) * sizeof(Vertex),
+                perChunk * sizeof(Vertex), &staging[i * perChunk]);
+    }
+    for (TerrainChunk& c : tiles) c.dirty = false;
 
     glBindVertexArray(0);
 }
 
+size_t Terrain::drawnTriangles() const {
+    if (lod) return cdlod.triangles();
+    return size_t(visibleCount) * TERRAIN_CHUNK_CELLS * TERRAIN_CHUNK_CELLS * 2;
+}
+
 void Terrain::draw(const Shader& shader) const {
+    if (lod) {
+        cdlod.draw(shader, heightfield);
+        return;
+    }
+    bool compact = format == VertexFormat::Compact;
+    if (compact) {
+        // из них terrain.vert восстанавливает X/Z, UV и высоту
+        shader.setInt("gridSize", GRID_SIZE);
+        shader.setInt("chunkVerts", TERRAIN_CHUNK_CELLS + 1);
+        shader.setFloat("gridSpacing", heightfield.spacing());
+    }
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, (GLsizei)indexCount, GL_UNSIGNED_INT, 0);
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        if (!tileVisible[i]) continue;
+        const TerrainChunk& c = tiles[i];
+        if (compact) {
+            shader.setVec2("chunkNode", glm::vec2(c.x0, c.z0));
+            shader.setVec2("chunkLast", glm::vec2(c.cols - 1, c.rows - 1));
+            shader.setVec2("gridOrigin", glm::vec2(c.boundsMin.x, c.boundsMin.z));
+            shader.setVec2("heightRange", glm::vec2(c.boundsMin.y, c.boundsMax.y - c.boundsMin.y));
+        }
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)indexCount, GL_UNSIGNED_SHORT, 0, c.baseVertex);
+    }
     glBindVertexArray(0);
 }
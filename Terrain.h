@@ -1,30 +1,210 @@
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
+#include "Cdlod.h"
+#include "Heightfield.h"
+#include "HeightGenerator.h"
 
-class Shader; //  
+class Shader; // вперёд объявление
+
+// Формат вершины в VBO (раскладки — в VertexLayout.h)
+enum class VertexFormat {
+    Full,       // pos | normal | uv | tangent | bitangent  => 14 float (56 байт)
+    DerivedTBN, // pos | normal | uv => 8 float (32 байта); T и B строит terrain.vert
+    Compact     // height unorm16 | oct-нормаль 2 x snorm16 => 8 байт; X/Z и UV из gl_VertexID
+};
+
+// Готовые графы высоты (NoiseGraph) поверх параметров шума
+enum class TerrainGraph {
+    None,       // прямой путь: fBm -> (n*0.5+0.5)^2 * amplitude
+    Mountains,  // базовый фрактал, ridged-горы по низкочастотной маске
+    Mesas,      // кривая + террасы
+    Plateaus    // плато в клетках Worley поверх базового фрактала
+};
+
+// Чем строится поле высот
+enum class TerrainEngine {
+    Noise,          // шум по точкам: fBm / формы / графы
+    Spectral,       // обратное БПФ спектра 1/f^beta (Spectral.h)
+    DiamondSquare   // midpoint displacement (DiamondSquare.h)
+};
+
+// Параметры генерации (то, что крутят слайдеры)
+struct TerrainParams {
+    float amplitude = 50.0f;
+    float frequency = 0.04f;
+    int   octaves   = 4;
+    float offset    = 0.0f;
+    NoiseBasis basis = NoiseBasis::Perlin;
+    FractalType fractal = FractalType::Fbm;
+    float warpStrength  = 0.0f;   // domain warping, мировые единицы; 0 — выкл.
+    float warpFrequency = 0.02f;
+    int   seed      = 0;      // для базисов с таблицами (Perlin, Simplex)
+    // низкие октавы на редкой сетке + бикубика (generateFbmHeightsMultiRes)
+    bool  multiResolution = false;
+    // октавы выше частоты Найквиста сетки не считаются (fbmClampToSpacing)
+    bool  clampOctaves = true;
+    TerrainGraph graph = TerrainGraph::None;
+    TerrainEngine engine = TerrainEngine::Noise;
+    // Spectral: вместо частоты и октав — наклон спектра и полоса в периодах на
+    // тайл (0 — до Найквиста); seed общий
+    float spectralBeta = 1.0f;
+    int   spectralMinCycles = 1;
+    int   spectralMaxCycles = 0;
+    // DiamondSquare: множитель смещения на уровень
+    float roughness = 0.5f;
+
+    bool operator==(const TerrainParams& o) const {
+        return amplitude == o.amplitude && frequency == o.frequency &&
+               octaves == o.octaves && offset == o.offset &&
+               basis == o.basis && fractal == o.fractal && seed == o.seed &&
+               warpStrength == o.warpStrength && warpFrequency == o.warpFrequency &&
+               multiResolution == o.multiResolution && clampOctaves == o.clampOctaves &&
+               graph == o.graph && engine == o.engine && spectralBeta == o.spectralBeta &&
+               spectralMinCycles == o.spectralMinCycles && spectralMaxCycles == o.spectralMaxCycles &&
+               roughness == o.roughness;
+    }
+    bool operator!=(const TerrainParams& o) const { return !(*this == o); }
+};
+
+// Ячеек тайла по стороне: (64 + 1)^2 вершин — индексы влезают в 16 бит,
+// один EBO на все тайлы (glDrawElementsBaseVertex)
+constexpr int TERRAIN_CHUNK_CELLS = 64;
+
+// Тайл сетки: свой кусок высот (узлы [x0, x0 + cols) x [z0, z0 + rows)) и
+// свой диапазон в общем VBO. Соседние тайлы делят край: его узлы есть в
+// обоих, а нормали берутся из общих градиентов сетки — шва нет. Диапазон
+// всегда (CELLS + 1)^2 вершин; у крайних тайлов лишние повторяют край
+// (вырожденные треугольники).
+struct TerrainChunk {
+    int x0 = 0, z0 = 0;
+    int cols = 0, rows = 0;
+    Heightfield heights;     // копия куска с градиентами: по ней видно, изменился ли тайл
+    GLint baseVertex = 0;
+    glm::vec3 boundsMin{ 0.0f }, boundsMax{ 0.0f };  // AABB в мировых координатах
+    bool dirty = true;       // вершины надо перепаковать
+};
 
 class Terrain {
 public:
-    Terrain(int gridSize, float worldSize);
+    Terrain(int gridSize, float worldSize, VertexFormat format = VertexFormat::DerivedTBN);
     ~Terrain();
 
-    // :  , , , 
-    void generate(float amplitude, float frequency, int octaves, float offset);
+    // Синхронно: высоты и меш сразу (GL-поток)
+    void generate(const TerrainParams& params);
+
+    // Асинхронно: высоты считаются в фоновом потоке, пока рисуется старый меш.
+    // Новый запрос отменяет незавершённый, из серии запросов считается только
+    // последний. update() в GL-потоке подхватывает готовую сетку и
+    // перестраивает меш; true — меш обновился.
+    void requestGenerate(const TerrainParams& params);
+    bool update();
+    bool generating() const;
+    // Ждёт, пока фоновый поток не доделает всё запрошенное
+    // (например, перед ThreadPool::setThreadCount)
+    void waitIdle();
+    const TerrainParams& params() const { return current; }
+    // Статистика генерации, по которой построена текущая сетка
+    const GenerationStats& stats() const { return currentStats; }
+
     void draw(const Shader& shader) const;
 
+    const Heightfield& heights() const { return heightfield; }
+
+    // Правка высот на месте (кисть, эрозия): fn меняет узлы в [x0, x1] x [z0, z1],
+    // градиенты пересчитываются рядом с правкой, вершины — только у задетых тайлов
+    void editHeights(int x0, int z0, int x1, int z1, const std::function<void(Heightfield&)>& fn);
+
+    const std::vector<TerrainChunk>& chunks() const { return tiles; }
+    // Сколько тайлов перепаковано последним построением меша
+    int chunksRebuilt() const { return lastRebuilt; }
+
+    // Отсечение тайлов пирамидой видимости projection * view * model (SIMD,
+    // пачками по 8 AABB); draw() рисует только прошедшие. До первого вызова
+    // видны все. В режиме CDLOD — выбор узлов по eye (камера в координатах
+    // модели) и их отсечение; projScale — высота вьюпорта / (2 tan(fovY / 2)).
+    void cull(const glm::mat4& viewProjection, const glm::vec3& eye, float projScale);
+    int  visibleChunks() const { return visibleCount; }
+    // Треугольников в draw() после cull()
+    size_t drawnTriangles() const;
+
+    // CDLOD вместо тайлов: квадродерево над сеткой, один патч на все узлы,
+    // высоты из текстуры (Cdlod.h); шейдер — lodShaderDefines()
+    void setLod(bool enabled);
+    bool lodEnabled() const { return lod; }
+    // Допустимая ошибка рельефа на экране, пикселей
+    void  setLodPixelError(float pixels) { lodError = pixels; }
+    float lodPixelError() const { return lodError; }
+    const CdlodRenderer& lodRenderer() const { return cdlod; }
+    static const char* lodShaderDefines();
+
+    // Смена формата пересобирает меш из текущей сетки высот
+    void setVertexFormat(VertexFormat format);
+    VertexFormat vertexFormat() const { return format; }
+    // #define для Shader под текущий формат
+    static const char* shaderDefines(VertexFormat format);
+
 private:
     int   GRID_SIZE;
     float WORLD_SIZE;
-    GLuint VAO, VBO, EBO;
+    GLuint VAO, VBO;
+    GLuint EBO;           // общий для всех тайлов всех Terrain, см. acquireIndices
+    int    indexChunk;    // размер тайла, под который взят EBO (0 — не взят)
     size_t indexCount;
+    VertexFormat format;
+
+    Heightfield heightfield;  // заполняется первым, меш строится из него
+    std::vector<TerrainChunk> tiles;
+    int tilesGrid = 0;     // GRID_SIZE, под который разложены тайлы
+    // AABB тайлов для frustumCull: minX, minY, minZ, maxX, maxY, maxZ
+    std::vector<float> tileBounds[6];
+    std::vector<uint8_t> tileVisible;
+    int visibleCount = 0;
+    int lastRebuilt = 0;
+    bool  lod = false;
+    float lodError = 1.0f;
+    CdlodRenderer cdlod;
+    TerrainParams current;    // параметры, по которым построена heightfield
+    GenerationStats currentStats;
+
+    // Фоновая генерация: worker пишет в backField, готовый результат
+    // переезжает в readyField, update() меняет его местами с heightfield
+    std::thread worker;
+    mutable std::mutex asyncMutex;
+    std::condition_variable asyncCv, idleCv;
+    std::atomic<bool> cancelJob{ false };
+    TerrainParams pendingParams, readyParams;
+    GenerationStats backStats, readyStats;
+    bool hasPending = false, working = false, hasReady = false, stopWorker = false;
+    unsigned requestSerial = 0;  // растёт с каждым generate/requestGenerate
+    Heightfield backField, readyField;
+
+    // суммы октав прошлых генераций: амплитуда и число октав меняются без
+    // пересчёта всего шума; общий для generate() и фонового потока
+    FbmFieldCache fbmCache;
+    GraphFieldCache graphCache;  // буферы узлов графа пресета
+    std::mutex cacheMutex;
 
-    // x,y,z | nx,ny,nz | tx,ty | tan.x,y,z | bitan.x,y,z  => 14 float
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+    // VBO выделяется один раз под размер/формат, дальше только перезаписывается
+    size_t vboBytes;      // размер выделенного хранилища VBO
+    int    vboFormat;     // формат, под который заданы атрибуты VAO (-1 — ещё нет)
 
-    void computeNormals();
-    void computeTangents();
-    void setupMesh();
+    void buildMesh();
+    void layoutChunks();
+    void syncChunk(TerrainChunk& c);
+    void updateTileBounds();
+    void workerLoop();
+    bool generateHeights(Heightfield& hf, const TerrainParams& params, GenerationStats& stats,
+                         const std::atomic<bool>* cancel = nullptr);
+    void acquireIndices(int chunkCells);
+    void releaseIndices();
+    template<typename Layout> void packChunk(const TerrainChunk& c, typename Layout::Vertex* out) const;
+    template<typename Layout> void uploadVertices();
 };
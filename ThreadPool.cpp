@@ -0,0 +1,113 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+struct ThreadPool::Job {
+    const std::function<void(int, int)>* fn;
+    int begin, end, grain, chunks;
+    std::atomic<int> next{ 0 };  // следующий незанятый кусок
+    std::atomic<int> done{ 0 };  // завершённые куски
+    std::mutex mtx;
+    std::condition_variable cv;
+};
+
+ThreadPool::ThreadPool(int threads) {
+    start(threads);
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+int ThreadPool::hardwareThreads() {
+    return std::max(1, int(std::thread::hardware_concurrency()));
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::start(int threads) {
+    if (threads <= 0) threads = hardwareThreads();
+    stopping = false;
+    for (int i = 1; i < threads; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+void ThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& t : workers) t.join();
+    workers.clear();
+    queue.clear();
+}
+
+void ThreadPool::setThreadCount(int threads) {
+    if (threads <= 0) threads = hardwareThreads();
+    if (threads == threadCount()) return;
+    stop();
+    start(threads);
+}
+
+void ThreadPool::runChunks(Job& job) {
+    for (;;) {
+        int c = job.next.fetch_add(1);
+        if (c >= job.chunks) return;
+        int b = job.begin + c * job.grain;
+        int e = std::min(job.end, b + job.grain);
+        (*job.fn)(b, e);
+        if (job.done.fetch_add(1) + 1 == job.chunks) {
+            std::lock_guard<std::mutex> lock(job.mtx);
+            job.cv.notify_all();
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        runChunks(*job);
+    }
+}
+
+void ThreadPool::parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn) {
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+    int chunks = (end - begin + grain - 1) / grain;
+    if (chunks == 1 || workers.empty()) {
+        for (int b = begin; b < end; b += grain)
+            fn(b, std::min(end, b + grain));
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->fn = &fn;
+    job->begin = begin;
+    job->end = end;
+    job->grain = grain;
+    job->chunks = chunks;
+
+    int helpers = std::min(int(workers.size()), chunks - 1);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (int i = 0; i < helpers; ++i) queue.push_back(job);
+    }
+    if (helpers == 1) cv.notify_one(); else cv.notify_all();
+
+    runChunks(*job);
+
+    // fn живёт на стеке вызывающего: ждём все куски, а не только свои
+    std::unique_lock<std::mutex> lock(job->mtx);
+    job->cv.wait(lock, [&] { return job->done.load() == job->chunks; });
+}
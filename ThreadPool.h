@@ -0,0 +1,45 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Постоянный пул потоков для генерации: parallelFor режет диапазон на куски
+// по grain, вызывающий поток тоже работает. Куски не зависят от числа
+// потоков, поэтому результат побитово одинаков при любом threadCount().
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads = 0); // 0 = std::thread::hardware_concurrency()
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Всего потоков, включая вызывающий. Нельзя звать во время parallelFor.
+    void setThreadCount(int threads);
+    int  threadCount() const { return int(workers.size()) + 1; }
+
+    // fn(b, e) для [begin, end) кусками по grain; блокирует до завершения.
+    // Можно звать из нескольких потоков одновременно.
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn);
+
+    static ThreadPool& shared();
+    static int hardwareThreads();
+
+private:
+    struct Job;
+
+    std::vector<std::thread> workers;
+    std::deque<std::shared_ptr<Job>> queue;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+
+    void start(int threads);
+    void stop();
+    void workerLoop();
+    static void runChunks(Job& job);
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Атрибут вершины: всё, что нужно glVertexAttribPointer, известно при компиляции
+template<GLuint Location, GLint Size, GLenum Type, GLboolean Normalized, size_t Offset>
+struct VertexAttrib {
+    static void apply(GLsizei stride) {
+        glEnableVertexAttribArray(Location);
+        glVertexAttribPointer(Location, Size, Type, Normalized, stride, (void*)Offset);
+    }
+};
+
+// Раскладка = тип вершины + список атрибутов. И упаковка на CPU (Layout::pack
+// пишет в Layout::Vertex), и настройка VAO (Layout::apply) берут одно описание,
+// поэтому stride и смещения не могут разъехаться.
+template<typename VertexT, typename... Attribs>
+struct VertexLayout {
+    using Vertex = VertexT;
+    static constexpr GLsizei stride = GLsizei(sizeof(VertexT));
+    static constexpr GLuint maxLocations = 5;  // aPos..aBitangent в terrain.vert
+
+    // VAO должен быть привязан, GL_ARRAY_BUFFER — тоже
+    static void apply() {
+        for (GLuint i = 0; i < maxLocations; ++i) glDisableVertexAttribArray(i);
+        (Attribs::apply(stride), ...);
+    }
+};
+
+// Всё, из чего пакуется одна вершина сетки
+struct VertexSource {
+    int gx, gz;          // узел сетки
+    glm::vec3 pos;
+    glm::vec3 normal;    // единичная
+    glm::vec2 uv;
+    float heightUnorm;   // (h - min) / (max - min)
+};
+
+// UV идут вдоль X/Z: T — касательная вдоль x, B = N x T (как в terrain.vert)
+inline void tangentFrame(const glm::vec3& n, glm::vec3& t, glm::vec3& b) {
+    t = glm::normalize(glm::vec3(n.y, -n.x, 0.0f));
+    b = glm::cross(n, t);
+}
+
+// Октаэдрическое кодирование единичного вектора (ось полусферы — +Y);
+// обратное — octDecode в terrain.vert
+inline glm::vec2 octEncode(const glm::vec3& n) {
+    glm::vec2 p = glm::vec2(n.x, n.z) / (std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z));
+    if (n.y < 0.0f) {
+        glm::vec2 s(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+        p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) * s;
+    }
+    return p;
+}
+
+inline int16_t toSnorm16(float v) {
+    return int16_t(std::lround(glm::clamp(v, -1.0f, 1.0f) * 32767.0f));
+}
+
+inline uint16_t toUnorm16(float v) {
+    return uint16_t(std::lround(glm::clamp(v, 0.0f, 1.0f) * 65535.0f));
+}
+
+// ---- Full: pos | normal | uv | tangent | bitangent, 56 байт ----
+struct FullVertex { float pos[3], normal[3], uv[2], tangent[3], bitangent[3]; };
+
+struct FullLayout : VertexLayout<FullVertex,
+    VertexAttrib<0, 3, GL_FLOAT, GL_FALSE, offsetof(FullVertex, pos)>,
+    VertexAttrib<1, 3, GL_FLOAT, GL_FALSE, offsetof(FullVertex, normal)>,
+    VertexAttrib<2, 2, GL_FLOAT, GL_FALSE, offsetof(FullVertex, uv)>,
+    VertexAttrib<3, 3, GL_FLOAT, GL_FALSE, offsetof(FullVertex, tangent)>,
+    VertexAttrib<4, 3, GL_FLOAT, GL_FALSE, offsetof(FullVertex, bitangent)>>
+{
+    static void pack(const VertexSource& s, FullVertex& v) {
+        glm::vec3 t, b;
+        tangentFrame(s.normal, t, b);
+        v = { { s.pos.x, s.pos.y, s.pos.z }, { s.normal.x, s.normal.y, s.normal.z },
+              { s.uv.x, s.uv.y }, { t.x, t.y, t.z }, { b.x, b.y, b.z } };
+    }
+};
+
+// ---- DerivedTBN: pos | normal | uv, 32 байта ----
+struct LeanVertex { float pos[3], normal[3], uv[2]; };
+
+struct LeanLayout : VertexLayout<LeanVertex,
+    VertexAttrib<0, 3, GL_FLOAT, GL_FALSE, offsetof(LeanVertex, pos)>,
+    VertexAttrib<1, 3, GL_FLOAT, GL_FALSE, offsetof(LeanVertex, normal)>,
+    VertexAttrib<2, 2, GL_FLOAT, GL_FALSE, offsetof(LeanVertex, uv)>>
+{
+    static void pack(const VertexSource& s, LeanVertex& v) {
+        v = { { s.pos.x, s.pos.y, s.pos.z }, { s.normal.x, s.normal.y, s.normal.z }, { s.uv.x, s.uv.y } };
+    }
+};
+
+// ---- Compact: height unorm16 | octahedral normal 2 x snorm16, 8 байт ----
+// X/Z и UV восстанавливаются в шейдере из gl_VertexID и uniform'ов сетки,
+// высота — из heightRange (min, max - min)
+struct CompactVertex {
+    uint16_t height;
+    uint16_t pad;        // выравнивание нормали на 4 байта
+    int16_t  normal[2];
+};
+
+struct CompactLayout : VertexLayout<CompactVertex,
+    VertexAttrib<0, 1, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(CompactVertex, height)>,
+    VertexAttrib<1, 2, GL_SHORT, GL_TRUE, offsetof(CompactVertex, normal)>>
+{
+    static void pack(const VertexSource& s, CompactVertex& v) {
+        glm::vec2 e = octEncode(s.normal);
+        v = { toUnorm16(s.heightUnorm), 0, { toSnorm16(e.x), toSnorm16(e.y) } };
+    }
+};
+
+static_assert(sizeof(FullVertex) == 56, "FullVertex must stay 14 floats");
+static_assert(sizeof(LeanVertex) == 32, "LeanVertex must stay 8 floats");
+static_assert(sizeof(CompactVertex) <= 8, "CompactVertex must fit in 8 bytes");
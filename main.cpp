@@ -4,14 +4,19 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include "Benchmark.h"
 #include "Camera.h"
 #include "Shader.h"
 #include "Terrain.h"
+#include "ThreadPool.h"
 #include <imgui.h>
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 
-//  
+// размеры окна
 const unsigned SCR_W = 1920, SCR_H = 1080;
 
 void framebuffer_size_callback(GLFWwindow*, int w, int h) {
@@ -44,7 +49,11 @@ void mouse_callback(GLFWwindow* /*wnd*/, double xpos, double ypos) {
 }
 
 
-int main() {
+int main(int argc, char** argv) {
+    // замеры без окна
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+        return runBenchmarks(argc - 1, argv + 1);
+
     // GLFW
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -77,17 +86,23 @@ int main() {
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330 core");
 
-    // 
+    // камера
     
 
-    // 
-    Shader terrainShader("shaders/terrain.vert", "shaders/terrain.frag");
+    // шейдеры: по варианту на каждый VertexFormat
+    Shader terrainShaders[] = {
+        Shader("shaders/terrain.vert", "shaders/terrain.frag", Terrain::shaderDefines(VertexFormat::Full)),
+        Shader("shaders/terrain.vert", "shaders/terrain.frag", Terrain::shaderDefines(VertexFormat::DerivedTBN)),
+        Shader("shaders/terrain.vert", "shaders/terrain.frag", Terrain::shaderDefines(VertexFormat::Compact)),
+    };
+    // и CDLOD: один патч, высоты из текстуры
+    Shader lodShader("shaders/terrain.vert", "shaders/terrain.frag", Terrain::lodShaderDefines());
 
-    // 
+    // террейн
     Terrain terrain(128, 64.0f);
-    terrain.generate(50.0f, 0.04f, 4, 0.0f);
+    terrain.generate(TerrainParams{});
 
-    // 
+    // текстуры
     auto loadTex = [&](const char* path) -> GLuint {
         int w, h, n;
         unsigned char* data = stbi_load(path, &w, &h, &n, 0);
@@ -100,7 +115,7 @@ int main() {
         if (n == 1) {
             internalFormat = GL_R8;
             format = GL_RED;
-            //   1- :
+            // важно для 1-байтовых строк:
             glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
         }
         else if (n == 3) {
@@ -112,7 +127,7 @@ int main() {
             format = GL_RGBA;
         }
         else {
-            //  
+            // неожиданный формат
             stbi_image_free(data);
             std::cerr << "Unsupported channels: " << n << " in " << path << "\n";
             return 0;
@@ -125,7 +140,7 @@ int main() {
             w, h, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
-        //   
+        // ваши привычные параметры
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -153,10 +168,10 @@ int main() {
 
 
     // shadow map setup omitted for brevity...
-    // lightSpaceMatrix, FBO  depthTexture   
+    // lightSpaceMatrix, FBO и depthTexture надо создать здесь
 
-    float sunElevationDeg = 15.0f;               //    
-    float sunAzimuthDeg = 0.0f;               //    ( )
+    float sunElevationDeg = 15.0f;               // угол возвышения над горизонтом
+    float sunAzimuthDeg = 0.0f;               // направление по горизонтали (по желанию)
     float ambientIntensity = 0.23f;
     float diffuseIntensity = 4.4f;
     float specularIntensity = 0.4f;
@@ -172,20 +187,20 @@ int main() {
 
 
 
-    // 
+    // цикл
     while (!glfwWindowShouldClose(window)) {
         float current = (float)glfwGetTime();
         static float lastTime = current;
         float deltaTime = current - lastTime;
         lastTime = current;
 
-        // 
+        // ввод
         glfwPollEvents();
         if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
             if (!mouseCaptured) {
                 mouseCaptured = true;
                 glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-                firstMouse = true;  //   ,   
+                firstMouse = true;  // сбросим дельту мыши, чтобы избежать рывка
             }
         }
         else {
@@ -208,20 +223,137 @@ int main() {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
         {
-            static float amp = 50, freq = 0.04f, ofs = 0; 
-            static int oct = 4;
-            static float sunAzimuth = 0.0f;   //   0360
-            static float sunElevation = 15.0f;  //   090
+            static TerrainParams params = terrain.params();
+            static int threads = ThreadPool::shared().threadCount();
+            static int vertexFormat = int(terrain.vertexFormat());
+            static float sunAzimuth = 0.0f;   // в градусах 0–360
+            static float sunElevation = 15.0f;  // угол возвышения 0–90
             static float ambientInt = ambientIntensity;
             static float diffuseInt = diffuseIntensity;
             static float specularInt = specularIntensity;
 
             ImGui::Begin("Terrain");
 
-            if (ImGui::SliderFloat("Amplitude", &amp, 0, 100)) terrain.generate(amp, freq, oct, ofs);
-            if (ImGui::SliderFloat("Frequency", &freq, 0, 0.1f)) terrain.generate(amp, freq, oct, ofs);
-            if (ImGui::SliderInt("Octaves", &oct, 1, 8))     terrain.generate(amp, freq, oct, ofs);
-            if (ImGui::SliderFloat("Offset", &ofs, -1000, 1000)) terrain.generate(amp, freq, oct, ofs);
+            // генерация в фоне: старый меш рисуется, пока не готов новый
+            bool changed = false;
+            changed |= ImGui::SliderFloat("Amplitude", &params.amplitude, 0, 100);
+            {
+                static int engine = int(params.engine);
+                if (ImGui::Combo("Engine", &engine, "Noise (per sample)\0Spectral (FFT)\0Diamond-square\0")) {
+                    params.engine = TerrainEngine(engine);
+                    changed = true;
+                }
+            }
+            if (params.engine == TerrainEngine::Spectral) {
+                // полоса в периодах на тайл; 0 у верхней границы — до Найквиста
+                changed |= ImGui::SliderFloat("Beta (1/f^beta)", &params.spectralBeta, 0.5f, 3.0f);
+                changed |= ImGui::SliderInt("Low cut (cycles)", &params.spectralMinCycles, 1, 64);
+                changed |= ImGui::SliderInt("High cut (cycles, 0 = Nyquist)", &params.spectralMaxCycles, 0, 256);
+                // верхняя граница не ниже нижней (0 — Найквист, её не трогаем)
+                if (params.spectralMaxCycles != 0 && params.spectralMaxCycles < params.spectralMinCycles) {
+                    params.spectralMaxCycles = params.spectralMinCycles;
+                    changed = true;
+                }
+                changed |= ImGui::InputInt("Seed", &params.seed);
+            }
+            else if (params.engine == TerrainEngine::DiamondSquare) {
+                changed |= ImGui::SliderFloat("Roughness", &params.roughness, 0.2f, 0.8f);
+                changed |= ImGui::InputInt("Seed", &params.seed);
+            }
+            else {
+                changed |= ImGui::SliderFloat("Frequency", &params.frequency, 0, 0.1f);
+                changed |= ImGui::SliderInt("Octaves", &params.octaves, 1, 8);
+                changed |= ImGui::SliderFloat("Offset", &params.offset, -1000, 1000);
+                {
+                    static int basis = int(params.basis);
+                    if (ImGui::Combo("Noise", &basis, "Perlin (seeded)\0glm::perlin\0Simplex\0")) {
+                        params.basis = NoiseBasis(basis);
+                        changed = true;
+                    }
+                }
+                {
+                    static int fractal = int(params.fractal);
+                    if (ImGui::Combo("Shape", &fractal, "fBm\0Ridged multifractal\0Billow\0Hybrid multifractal\0")) {
+                        params.fractal = FractalType(fractal);
+                        changed = true;
+                    }
+                }
+                {
+                    static int graph = int(params.graph);
+                    if (ImGui::Combo("Graph", &graph, "Off\0Mountains (ridged by mask)\0Terraced mesas\0Cellular plateaus\0")) {
+                        params.graph = TerrainGraph(graph);
+                        changed = true;
+                    }
+                }
+                changed |= ImGui::SliderFloat("Warp strength", &params.warpStrength, 0, 20);
+                if (params.warpStrength > 0)
+                    changed |= ImGui::SliderFloat("Warp frequency", &params.warpFrequency, 0.001f, 0.1f);
+                if (params.basis != NoiseBasis::GlmPerlin)
+                    changed |= ImGui::InputInt("Seed", &params.seed);
+                changed |= ImGui::Checkbox("Multi-resolution octaves", &params.multiResolution);
+                changed |= ImGui::Checkbox("Clamp octaves to grid (Nyquist)", &params.clampOctaves);
+            }
+            if (ImGui::SliderInt("Threads", &threads, 1, ThreadPool::hardwareThreads())) {
+                // пул нельзя перестраивать, пока фоновая генерация в parallelFor
+                terrain.waitIdle();
+                ThreadPool::shared().setThreadCount(threads);
+                changed = true;
+            }
+            if (changed) terrain.requestGenerate(params);
+            if (terrain.generating()) ImGui::TextUnformatted("Generating...");
+            {
+                const GenerationStats& st = terrain.stats();
+                ImGui::Text("Octaves: %d requested, %d skipped (Nyquist), %d recomputed",
+                    st.octavesRequested, st.octavesSkipped, st.octavesEvaluated);
+                ImGui::Text("Noise: %.2f M samples, %.1f ms", st.noiseEvaluations * 1e-6, st.milliseconds);
+                if (terrain.lodEnabled()) {
+                    const CdlodTree& tree = terrain.lodRenderer().tree();
+                    ImGui::Text("LOD: %d levels, %d quads drawn", tree.levels(), terrain.lodRenderer().quads());
+                }
+                else {
+                    int chunks = int(terrain.chunks().size());
+                    ImGui::Text("Chunks: %d rebuilt of %d", terrain.chunksRebuilt(), chunks);
+                    ImGui::Text("Chunks: %d visible, %d culled (frustum)", terrain.visibleChunks(),
+                        chunks - terrain.visibleChunks());
+                }
+                ImGui::Text("Triangles: %.2f M", terrain.drawnTriangles() * 1e-6);
+            }
+            static bool lod = terrain.lodEnabled();
+            if (ImGui::Checkbox("CDLOD (quadtree LOD)", &lod))
+                terrain.setLod(lod);
+            if (lod) {
+                static float pixelError = terrain.lodPixelError();
+                if (ImGui::SliderFloat("LOD pixel error", &pixelError, 0.25f, 8.0f, "%.2f px"))
+                    terrain.setLodPixelError(pixelError);
+            }
+            else if (ImGui::Combo("Vertex format", &vertexFormat, "Full TBN (56 B)\0Derived TBN (32 B)\0Compact (8 B)\0"))
+                terrain.setVertexFormat(VertexFormat(vertexFormat));
+            {
+                // кисть под камерой: правка на месте, перепаковываются только
+                // задетые тайлы (см. "Chunks: rebuilt"); следующая генерация её сотрёт
+                static float brushRadius = 4.0f, brushStrength = 1.0f;
+                ImGui::SliderFloat("Brush radius", &brushRadius, 0.5f, 16.0f);
+                ImGui::SliderFloat("Brush strength", &brushStrength, -5.0f, 5.0f);
+                const Heightfield& hf = terrain.heights();
+                if (ImGui::Button("Apply brush under camera") && hf.size()) {
+                    float s = hf.spacing();
+                    float cx = (camera.Position.x - hf.originX()) / s, cz = (camera.Position.z - hf.originZ()) / s;
+                    float r = brushRadius / s;
+                    int x0 = std::max(int(std::ceil(cx - r)), 0), x1 = std::min(int(std::floor(cx + r)), hf.width() - 1);
+                    int z0 = std::max(int(std::ceil(cz - r)), 0), z1 = std::min(int(std::floor(cz + r)), hf.depth() - 1);
+                    if (x0 <= x1 && z0 <= z1) {
+                        terrain.editHeights(x0, z0, x1, z1, [&](Heightfield& h) {
+                            // гладкий купол: (1 + cos(pi * d / r)) / 2
+                            for (int z = z0; z <= z1; ++z)
+                                for (int x = x0; x <= x1; ++x) {
+                                    float d = std::sqrt((x - cx) * (x - cx) + (z - cz) * (z - cz)) / r;
+                                    if (d < 1.0f)
+                                        h.at(x, z) += brushStrength * 0.5f * (1.0f + std::cos(3.14159265f * d));
+                                }
+                            });
+                    }
+                }
+            }
             if (ImGui::SliderFloat("Sun Azimuth", &sunAzimuth, 0.0f, 360.0f)); 
             if (ImGui::SliderFloat("Sun Elevation", &sunElevation, 0.0f, 360.0f));
             if (ImGui::SliderFloat("Ambient", &ambientInt, 0.0f, 5.0f));
@@ -230,12 +362,12 @@ int main() {
 
             ImGui::End();
             {
-                //   
+                // сохраняем новые значения
                 ambientIntensity = ambientInt;
                 diffuseIntensity = diffuseInt;
                 specularIntensity = specularInt;
 
-                //   
+                // пересчёт направления солнца
                 float el = glm::radians(sunElevation);
                 float az = glm::radians(sunAzimuth);
                 glm::vec3 L = glm::normalize(glm::vec3(
@@ -248,12 +380,15 @@ int main() {
         }
 
 
-        // 
+        // рендер
         glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        // подхватываем результат фоновой генерации (меш строится здесь, в GL-потоке)
+        terrain.update();
+        const Shader& terrainShader = terrain.lodEnabled() ? lodShader : terrainShaders[int(terrain.vertexFormat())];
         terrainShader.use();
-        //  uniform': model, view, proj, lightSpaceMatrix, sun, viewPos   
+        // задаём uniform'ы: model, view, proj, lightSpaceMatrix, sun, viewPos и текстурные блоки
         glm::mat4 model = glm::mat4(1.0f);
         glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 proj = glm::perspective(glm::radians(camera.Zoom),
@@ -262,26 +397,30 @@ int main() {
         terrainShader.setMat4("model", model);
         terrainShader.setMat4("view", view);
         terrainShader.setMat4("projection", proj);
-        // shadow map      
+        // тайлы (или узлы CDLOD) вне пирамиды видимости не рисуются; model —
+        // единичная, так что камера в координатах модели — camera.Position
+        terrain.cull(proj * view * model, camera.Position,
+            SCR_H / (2.0f * std::tan(glm::radians(camera.Zoom) * 0.5f)));
+        // shadow map и параметры солнца нужно тоже сюда
 
-        //    
+        // позиция камеры в шейдер
         terrainShader.setVec3("viewPos", camera.Position);
 
 
 
-        //     :
+        // Вводим один вектор «цвета солнца»:
         static glm::vec3 sunColor(1.00f, 0.98f, 0.60f);
         ImGui::ColorEdit3("Sun Color", (float*)&sunColor);
 
 
 
-        //    ()
+        // параметры направленного света (Солнце)
         terrainShader.setVec3("lightDir", sunDir);
         terrainShader.setVec3("lightColor", sunColor * diffuseIntensity);
         terrainShader.setFloat("ambientFactor", ambientIntensity);
         terrainShader.setFloat("specularFactor", specularIntensity);
 
-        // 
+        // текстуры
         
         // Grass
         terrainShader.setInt("grassAlbedo", 0);
@@ -320,7 +459,7 @@ int main() {
         glfwSwapBuffers(window);
     }
 
-    // 
+    // очистка
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
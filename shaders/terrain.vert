@@ -1,9 +1,37 @@
 #version 330 core
+#ifdef TERRAIN_CDLOD
+// CDLOD: один патч на все узлы квадродерева; высота и градиент — из текстуры
+layout(location=0) in vec2 aGrid;       // вершина патча: 0..CDLOD_PATCH по X/Z
+
+uniform sampler2D heightMap;  // RGB32F: h, dh/dx, dh/dz по узлам сетки
+uniform vec2  gridOrigin;     // мировые X/Z узла (0, 0)
+uniform float gridSpacing;
+uniform vec2  gridNodes;      // узлов сетки по X/Z
+uniform vec2  nodeOrigin;     // мировые X/Z угла узла
+uniform float nodeScale;      // шаг патча на уровне узла: gridSpacing * 2^level
+uniform vec2  morphRange;     // расстояния начала и конца geomorph уровня
+uniform vec3  viewPos;
+#elif defined(TERRAIN_COMPACT_VERTEX)
+// 8 байт на вершину: X/Z и UV — из gl_VertexID, высота и нормаль — квантованные
+layout(location=0) in float aHeight;    // unorm16: (h - min) / (max - min)
+layout(location=1) in vec2  aNormalOct; // snorm16: октаэдрическая нормаль
+
+uniform int   gridSize;     // узлов всей сетки по стороне (для UV)
+uniform int   chunkVerts;   // вершин тайла по стороне (TERRAIN_CHUNK_CELLS + 1)
+uniform vec2  chunkNode;    // узел сетки первой вершины тайла
+uniform vec2  chunkLast;    // последний узел тайла; дальше вершины повторяют край
+uniform vec2  gridOrigin;   // мировые X/Z первой вершины тайла
+uniform float gridSpacing;
+uniform vec2  heightRange;  // min, max - min тайла
+#else
 layout(location=0) in vec3 aPos;
 layout(location=1) in vec3 aNormal;
 layout(location=2) in vec2 aTexCoord;
+#endif
+#ifndef TERRAIN_DERIVED_TBN
 layout(location=3) in vec3 aTangent;
 layout(location=4) in vec3 aBitangent;
+#endif
 
 out VS_OUT {
     vec3 FragPos;
@@ -15,15 +43,73 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+#ifdef TERRAIN_CDLOD
+// Узлы сетки — в центрах texel'ей, между ними — линейная фильтрация;
+// за краем сетки патч прижимается к краю
+vec3 sampleHeight(inout vec2 xz) {
+    xz = min(xz, gridOrigin + (gridNodes - 1.0) * gridSpacing);
+    return texture(heightMap, ((xz - gridOrigin) / gridSpacing + 0.5) / gridNodes).rgb;
+}
+#endif
+
+#ifdef TERRAIN_COMPACT_VERTEX
+// обратное к octEncode из VertexLayout.h (ось полусферы — +Y)
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0) {
+        vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+        n.xz = (1.0 - abs(n.zx)) * s;
+    }
+    return normalize(n);
+}
+#endif
+
 void main() {
-    vs_out.FragPos  = vec3(model * vec4(aPos, 1.0));
-    vs_out.TexCoord = aTexCoord;
+#ifdef TERRAIN_CDLOD
+    // geomorph: к концу диапазона уровня нечётные вершины патча съезжают на
+    // соседнюю чётную — сетка становится сеткой родителя, и смена уровня
+    // проходит без скачка
+    vec2  xz    = nodeOrigin + aGrid * nodeScale;
+    float h     = sampleHeight(xz).r;
+    float dist  = distance(viewPos, vec3(xz.x, h, xz.y));
+    float morph = clamp((dist - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);
+    vec2  g     = aGrid - fract(aGrid * 0.5) * 2.0 * morph;
+    xz = nodeOrigin + g * nodeScale;
+    vec3 s      = sampleHeight(xz);
+    vec3 pos    = vec3(xz.x, s.r, xz.y);
+    vec3 normal = normalize(vec3(-s.g, 1.0, -s.b));
+    vec2 uv     = (xz - gridOrigin) / gridSpacing / (gridNodes.x - 1.0) * 10.0; // тайлинг=10
+#elif defined(TERRAIN_COMPACT_VERTEX)
+    // gl_VertexID включает baseVertex тайла: диапазоны тайлов по chunkVerts^2
+    int  local  = gl_VertexID % (chunkVerts * chunkVerts);
+    vec2 cell   = min(vec2(local % chunkVerts, local / chunkVerts), chunkLast);
+    vec3 pos    = vec3(gridOrigin.x + cell.x * gridSpacing,
+                       heightRange.x + aHeight * heightRange.y,
+                       gridOrigin.y + cell.y * gridSpacing);
+    vec3 normal = octDecode(aNormalOct);
+    vec2 uv     = (chunkNode + cell) / float(gridSize - 1) * 10.0; // тайлинг=10
+#else
+    vec3 pos    = aPos;
+    vec3 normal = aNormal;
+    vec2 uv     = aTexCoord;
+#endif
+
+    vs_out.FragPos  = vec3(model * vec4(pos, 1.0));
+    vs_out.TexCoord = uv;
 
     // строим TBN
+#ifdef TERRAIN_DERIVED_TBN
+    // UV идут вдоль X/Z: T — касательная к поверхности вдоль x, B = N x T
+    vec3 tangent   = normalize(vec3(normal.y, -normal.x, 0.0));
+    vec3 bitangent = cross(normal, tangent);
+    vec3 T = normalize(mat3(model) * tangent);
+    vec3 B = normalize(mat3(model) * bitangent);
+#else
     vec3 T = normalize(mat3(model) * aTangent);
     vec3 B = normalize(mat3(model) * aBitangent);
-    vec3 N = normalize(mat3(model) * aNormal);
+#endif
+    vec3 N = normalize(mat3(model) * normal);
     vs_out.TBN = mat3(T, B, N);
 
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * vec4(pos, 1.0);
 }